@@ -0,0 +1,73 @@
+#ifndef PDF__ATOMIC_H_
+#define PDF__ATOMIC_H_
+
+/* Minimal atomics for reference counts and once-only publication of
+ * lazily built data. Uses compiler intrinsics, as C11 <stdatomic.h>
+ * isn't available under --std=gnu99 or older MSVC. */
+
+#include <stdint.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+
+/* returns the value before the increment */
+static uint32_t _atomic_fetch_inc(uint32_t* p) {
+    return (uint32_t) _InterlockedIncrement((volatile long*) p) - 1;
+}
+
+/* returns the value before the decrement */
+static uint32_t _atomic_fetch_dec(uint32_t* p) {
+    return (uint32_t) _InterlockedDecrement((volatile long*) p) + 1;
+}
+
+static void* _atomic_load_ptr(void** p) {
+    return _InterlockedCompareExchangePointer((void* volatile*) p, NULL, NULL);
+}
+
+static void _atomic_store_size(size_t* p, size_t v) {
+    _InterlockedExchangePointer((void* volatile*) p, (void*) v);
+}
+
+static size_t _atomic_load_size(size_t* p) {
+    return (size_t) _InterlockedCompareExchangePointer((void* volatile*) p, NULL, NULL);
+}
+
+/* publishes v at *p, if it's still NULL. Returns the published value */
+static void* _atomic_publish_ptr(void** p, void* v) {
+    void* prev = _InterlockedCompareExchangePointer((void* volatile*) p, v, NULL);
+    return prev ? prev : v;
+}
+
+#else
+
+static inline uint32_t _atomic_fetch_inc(uint32_t* p) {
+    return __atomic_fetch_add(p, 1, __ATOMIC_RELAXED);
+}
+
+static inline uint32_t _atomic_fetch_dec(uint32_t* p) {
+    return __atomic_fetch_sub(p, 1, __ATOMIC_ACQ_REL);
+}
+
+static inline void* _atomic_load_ptr(void** p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void _atomic_store_size(size_t* p, size_t v) {
+    __atomic_store_n(p, v, __ATOMIC_RELAXED);
+}
+
+static inline size_t _atomic_load_size(size_t* p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void* _atomic_publish_ptr(void** p, void* v) {
+    void* expected = NULL;
+    if (__atomic_compare_exchange_n(p, &expected, v, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        return v;
+    }
+    return expected;
+}
+
+#endif
+
+#endif
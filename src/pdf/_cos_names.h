@@ -0,0 +1,439 @@
+#ifndef PDF__COS_NAMES_H_
+#define PDF__COS_NAMES_H_
+
+/* Common names that are shared by cos_name_new(), cos_name_new_in() and the
+ * parser. Ordered by descending length, then by code points, to match
+ * _cmp_names(). Keep sorted, and within COS_NAME_INTERN_MAX_LEN, when adding
+ * entries. */
+
+static PDF_TYPE_CODE_POINT _intern_code_points[] = {
+    'B', 'i', 't', 's', 'P', 'e', 'r', 'C', 'o', 'o', 'r', 'd', 'i', 'n', 'a', 't', 'e',
+    'B', 'i', 't', 's', 'P', 'e', 'r', 'C', 'o', 'm', 'p', 'o', 'n', 'e', 'n', 't',
+    'D', 'e', 's', 'c', 'e', 'n', 'd', 'a', 'n', 't', 'F', 'o', 'n', 't', 's',
+    'W', 'i', 'n', 'A', 'n', 's', 'i', 'E', 'n', 'c', 'o', 'd', 'i', 'n', 'g',
+    'F', 'o', 'n', 't', 'D', 'e', 's', 'c', 'r', 'i', 'p', 't', 'o', 'r',
+    'C', 'I', 'D', 'S', 'y', 's', 't', 'e', 'm', 'I', 'n', 'f', 'o',
+    'B', 'a', 's', 'e', 'E', 'n', 'c', 'o', 'd', 'i', 'n', 'g',
+    'C', 'I', 'D', 'F', 'o', 'n', 't', 'T', 'y', 'p', 'e', '0',
+    'C', 'I', 'D', 'F', 'o', 'n', 't', 'T', 'y', 'p', 'e', '2',
+    'C', 'r', 'e', 'a', 't', 'i', 'o', 'n', 'D', 'a', 't', 'e',
+    'F', 'u', 'n', 'c', 't', 'i', 'o', 'n', 'T', 'y', 'p', 'e',
+    'M', 'i', 's', 's', 'i', 'n', 'g', 'W', 'i', 'd', 't', 'h',
+    'O', 'C', 'P', 'r', 'o', 'p', 'e', 'r', 't', 'i', 'e', 's',
+    'B', 'i', 't', 's', 'P', 'e', 'r', 'F', 'l', 'a', 'g',
+    'C', 'I', 'D', 'T', 'o', 'G', 'I', 'D', 'M', 'a', 'p',
+    'D', 'e', 'c', 'o', 'd', 'e', 'P', 'a', 'r', 'm', 's',
+    'D', 'i', 'f', 'f', 'e', 'r', 'e', 'n', 'c', 'e', 's',
+    'E', 'a', 'r', 'l', 'y', 'C', 'h', 'a', 'n', 'g', 'e',
+    'F', 'l', 'a', 't', 'e', 'D', 'e', 'c', 'o', 'd', 'e',
+    'I', 't', 'a', 'l', 'i', 'c', 'A', 'n', 'g', 'l', 'e',
+    'J', 'B', 'I', 'G', '2', 'D', 'e', 'c', 'o', 'd', 'e',
+    'P', 'a', 't', 't', 'e', 'r', 'n', 'T', 'y', 'p', 'e',
+    'S', 'h', 'a', 'd', 'i', 'n', 'g', 'T', 'y', 'p', 'e',
+    'C', 'o', 'l', 'o', 'r', 'S', 'p', 'a', 'c', 'e',
+    'D', 'e', 'v', 'i', 'c', 'e', 'C', 'M', 'Y', 'K',
+    'D', 'e', 'v', 'i', 'c', 'e', 'G', 'r', 'a', 'y',
+    'F', 'o', 'n', 't', 'M', 'a', 't', 'r', 'i', 'x',
+    'I', 'd', 'e', 'n', 't', 'i', 't', 'y', '-', 'H',
+    'J', 'a', 'v', 'a', 'S', 'c', 'r', 'i', 'p', 't',
+    'O', 'p', 'e', 'n', 'A', 'c', 't', 'i', 'o', 'n',
+    'P', 'a', 'g', 'e', 'L', 'a', 'b', 'e', 'l', 's',
+    'P', 'a', 'g', 'e', 'L', 'a', 'y', 'o', 'u', 't',
+    'P', 'r', 'o', 'p', 'e', 'r', 't', 'i', 'e', 's',
+    'S', 'e', 'p', 'a', 'r', 'a', 't', 'i', 'o', 'n',
+    'S', 'u', 'p', 'p', 'l', 'e', 'm', 'e', 'n', 't',
+    'C', 'a', 'p', 'H', 'e', 'i', 'g', 'h', 't',
+    'C', 'h', 'a', 'r', 'P', 'r', 'o', 'c', 's',
+    'D', 'C', 'T', 'D', 'e', 'c', 'o', 'd', 'e',
+    'D', 'e', 'v', 'i', 'c', 'e', 'R', 'G', 'B',
+    'E', 'x', 't', 'G', 'S', 't', 'a', 't', 'e',
+    'F', 'i', 'r', 's', 't', 'C', 'h', 'a', 'r',
+    'F', 'o', 'n', 't', 'F', 'i', 'l', 'e', '2',
+    'F', 'o', 'n', 't', 'F', 'i', 'l', 'e', '3',
+    'F', 'u', 'n', 'c', 't', 'i', 'o', 'n', 's',
+    'I', 'm', 'a', 'g', 'e', 'M', 'a', 's', 'k',
+    'J', 'P', 'X', 'D', 'e', 'c', 'o', 'd', 'e',
+    'P', 'r', 'e', 'd', 'i', 'c', 't', 'o', 'r',
+    'R', 'e', 's', 'o', 'u', 'r', 'c', 'e', 's',
+    'T', 'o', 'U', 'n', 'i', 'c', 'o', 'd', 'e',
+    'A', 'v', 'g', 'W', 'i', 'd', 't', 'h',
+    'B', 'a', 's', 'e', 'F', 'o', 'n', 't',
+    'C', 'o', 'n', 't', 'e', 'n', 't', 's',
+    'E', 'n', 'c', 'o', 'd', 'i', 'n', 'g',
+    'F', 'o', 'n', 't', 'B', 'B', 'o', 'x',
+    'F', 'o', 'n', 't', 'F', 'i', 'l', 'e',
+    'F', 'o', 'n', 't', 'N', 'a', 'm', 'e',
+    'F', 'o', 'r', 'm', 'T', 'y', 'p', 'e',
+    'F', 'u', 'n', 'c', 't', 'i', 'o', 'n',
+    'I', 'C', 'C', 'B', 'a', 's', 'e', 'd',
+    'I', 'd', 'e', 'n', 't', 'i', 't', 'y',
+    'L', 'a', 's', 't', 'C', 'h', 'a', 'r',
+    'M', 'a', 'x', 'W', 'i', 'd', 't', 'h',
+    'M', 'e', 'd', 'i', 'a', 'B', 'o', 'x',
+    'M', 'e', 't', 'a', 'd', 'a', 't', 'a',
+    'O', 'r', 'd', 'e', 'r', 'i', 'n', 'g',
+    'O', 'u', 't', 'l', 'i', 'n', 'e', 's',
+    'P', 'a', 'g', 'e', 'M', 'o', 'd', 'e',
+    'P', 'r', 'o', 'd', 'u', 'c', 'e', 'r',
+    'R', 'e', 'g', 'i', 's', 't', 'r', 'y',
+    'T', 'r', 'u', 'e', 'T', 'y', 'p', 'e',
+    'C', 'a', 'l', 'G', 'r', 'a', 'y',
+    'C', 'a', 't', 'a', 'l', 'o', 'g',
+    'C', 'h', 'a', 'r', 'S', 'e', 't',
+    'C', 'o', 'l', 'u', 'm', 'n', 's',
+    'C', 'r', 'e', 'a', 't', 'o', 'r',
+    'C', 'r', 'o', 'p', 'B', 'o', 'x',
+    'D', 'e', 'f', 'a', 'u', 'l', 't',
+    'D', 'e', 's', 'c', 'e', 'n', 't',
+    'D', 'e', 'v', 'i', 'c', 'e', 'N',
+    'E', 'n', 'c', 'r', 'y', 'p', 't',
+    'I', 'n', 'd', 'e', 'x', 'e', 'd',
+    'L', 'e', 'a', 'd', 'i', 'n', 'g',
+    'L', 'e', 'n', 'g', 't', 'h', '1',
+    'L', 'e', 'n', 'g', 't', 'h', '2',
+    'L', 'e', 'n', 'g', 't', 'h', '3',
+    'M', 'o', 'd', 'D', 'a', 't', 'e',
+    'P', 'a', 't', 't', 'e', 'r', 'n',
+    'P', 'r', 'o', 'c', 'S', 'e', 't',
+    'P', 'r', 'o', 'c', 's', 'e', 't',
+    'S', 'h', 'a', 'd', 'i', 'n', 'g',
+    'S', 'u', 'b', 't', 'y', 'p', 'e',
+    'T', 'r', 'i', 'm', 'B', 'o', 'x',
+    'V', 'e', 'r', 's', 'i', 'o', 'n',
+    'X', 'H', 'e', 'i', 'g', 'h', 't',
+    'X', 'O', 'b', 'j', 'e', 'c', 't',
+    'X', 'R', 'e', 'f', 'S', 't', 'm',
+    'A', 'c', 't', 'i', 'o', 'n',
+    'A', 'n', 'n', 'o', 't', 's',
+    'A', 's', 'c', 'e', 'n', 't',
+    'B', 'o', 'r', 'd', 'e', 'r',
+    'B', 'o', 'u', 'n', 'd', 's',
+    'C', 'a', 'l', 'R', 'G', 'B',
+    'C', 'o', 'l', 'o', 'r', 's',
+    'C', 'o', 'o', 'r', 'd', 's',
+    'D', 'e', 'c', 'o', 'd', 'e',
+    'D', 'o', 'm', 'a', 'i', 'n',
+    'E', 'n', 'c', 'o', 'd', 'e',
+    'E', 'x', 't', 'e', 'n', 'd',
+    'F', 'i', 'e', 'l', 'd', 's',
+    'F', 'i', 'l', 't', 'e', 'r',
+    'H', 'e', 'i', 'g', 'h', 't',
+    'I', 'm', 'a', 'g', 'e', 'B',
+    'I', 'm', 'a', 'g', 'e', 'C',
+    'I', 'm', 'a', 'g', 'e', 'I',
+    'L', 'e', 'n', 'g', 't', 'h',
+    'L', 'i', 'm', 'i', 't', 's',
+    'M', 'a', 't', 'r', 'i', 'x',
+    'P', 'a', 'r', 'e', 'n', 't',
+    'R', 'o', 't', 'a', 't', 'e',
+    'W', 'i', 'd', 'g', 'e', 't',
+    'W', 'i', 'd', 't', 'h', 's',
+    'A', 'n', 'n', 'o', 't',
+    'C', 'o', 'u', 'n', 't',
+    'D', 'e', 's', 't', 's',
+    'F', 'i', 'r', 's', 't',
+    'F', 'l', 'a', 'g', 's',
+    'G', 'r', 'o', 'u', 'p',
+    'I', 'm', 'a', 'g', 'e',
+    'I', 'n', 'd', 'e', 'x',
+    'I', 's', 'M', 'a', 'p',
+    'N', 'a', 'm', 'e', 's',
+    'P', 'a', 'g', 'e', 's',
+    'R', 'a', 'n', 'g', 'e',
+    'S', 'M', 'a', 's', 'k',
+    'S', 't', 'e', 'm', 'V',
+    'T', 'i', 't', 'l', 'e',
+    'T', 'y', 'p', 'e', '0',
+    'T', 'y', 'p', 'e', '1',
+    'T', 'y', 'p', 'e', '3',
+    'W', 'i', 'd', 't', 'h',
+    'B', 'B', 'o', 'x',
+    'C', 'M', 'a', 'p',
+    'D', 'e', 's', 't',
+    'F', 'o', 'n', 't',
+    'F', 'o', 'r', 'm',
+    'I', 'n', 'f', 'o',
+    'K', 'i', 'd', 's',
+    'L', 'a', 'n', 'g',
+    'L', 'a', 's', 't',
+    'L', 'i', 'n', 'k',
+    'M', 'a', 's', 'k',
+    'N', 'a', 'm', 'e',
+    'N', 'e', 'x', 't',
+    'O', 'C', 'G', 's',
+    'P', 'a', 'g', 'e',
+    'P', 'r', 'e', 'v',
+    'R', 'e', 'c', 't',
+    'S', 'i', 'z', 'e',
+    'T', 'e', 'x', 't',
+    'T', 'y', 'p', 'e',
+    'X', 'R', 'e', 'f',
+    'A', 'I', 'S',
+    'O', 'f', 'f',
+    'U', 'R', 'I',
+    'A', 'A',
+    'A', 'P',
+    'A', 'S',
+    'B', 'M',
+    'B', 'S',
+    'C', 'A',
+    'C', 'F',
+    'C', 'S',
+    'D', 'A',
+    'D', 'L',
+    'D', 'R',
+    'D', 'W',
+    'F', 'T',
+    'F', 'f',
+    'I', 'D',
+    'J', 'S',
+    'L', 'W',
+    'O', 'C',
+    'O', 'n',
+    'S', 'A',
+    'S', 'M',
+    'T', 'R',
+    'W', '2',
+    'A',
+    'B',
+    'C',
+    'D',
+    'E',
+    'F',
+    'G',
+    'H',
+    'I',
+    'K',
+    'L',
+    'M',
+    'N',
+    'O',
+    'P',
+    'Q',
+    'R',
+    'S',
+    'T',
+    'U',
+    'V',
+    'W',
+    'X',
+};
+
+#define COS_NAME_INTERN(off, len) {COS_NODE_NAME, COS_TYPE_CHECK_SUM(COS_NODE_NAME), COS_NODE_FLAG_INTERNED, 1, _intern_code_points + (off), (len)}
+
+static CosName _intern_names[] = {
+    COS_NAME_INTERN(0, 17), /* BitsPerCoordinate */
+    COS_NAME_INTERN(17, 16), /* BitsPerComponent */
+    COS_NAME_INTERN(33, 15), /* DescendantFonts */
+    COS_NAME_INTERN(48, 15), /* WinAnsiEncoding */
+    COS_NAME_INTERN(63, 14), /* FontDescriptor */
+    COS_NAME_INTERN(77, 13), /* CIDSystemInfo */
+    COS_NAME_INTERN(90, 12), /* BaseEncoding */
+    COS_NAME_INTERN(102, 12), /* CIDFontType0 */
+    COS_NAME_INTERN(114, 12), /* CIDFontType2 */
+    COS_NAME_INTERN(126, 12), /* CreationDate */
+    COS_NAME_INTERN(138, 12), /* FunctionType */
+    COS_NAME_INTERN(150, 12), /* MissingWidth */
+    COS_NAME_INTERN(162, 12), /* OCProperties */
+    COS_NAME_INTERN(174, 11), /* BitsPerFlag */
+    COS_NAME_INTERN(185, 11), /* CIDToGIDMap */
+    COS_NAME_INTERN(196, 11), /* DecodeParms */
+    COS_NAME_INTERN(207, 11), /* Differences */
+    COS_NAME_INTERN(218, 11), /* EarlyChange */
+    COS_NAME_INTERN(229, 11), /* FlateDecode */
+    COS_NAME_INTERN(240, 11), /* ItalicAngle */
+    COS_NAME_INTERN(251, 11), /* JBIG2Decode */
+    COS_NAME_INTERN(262, 11), /* PatternType */
+    COS_NAME_INTERN(273, 11), /* ShadingType */
+    COS_NAME_INTERN(284, 10), /* ColorSpace */
+    COS_NAME_INTERN(294, 10), /* DeviceCMYK */
+    COS_NAME_INTERN(304, 10), /* DeviceGray */
+    COS_NAME_INTERN(314, 10), /* FontMatrix */
+    COS_NAME_INTERN(324, 10), /* Identity-H */
+    COS_NAME_INTERN(334, 10), /* JavaScript */
+    COS_NAME_INTERN(344, 10), /* OpenAction */
+    COS_NAME_INTERN(354, 10), /* PageLabels */
+    COS_NAME_INTERN(364, 10), /* PageLayout */
+    COS_NAME_INTERN(374, 10), /* Properties */
+    COS_NAME_INTERN(384, 10), /* Separation */
+    COS_NAME_INTERN(394, 10), /* Supplement */
+    COS_NAME_INTERN(404, 9), /* CapHeight */
+    COS_NAME_INTERN(413, 9), /* CharProcs */
+    COS_NAME_INTERN(422, 9), /* DCTDecode */
+    COS_NAME_INTERN(431, 9), /* DeviceRGB */
+    COS_NAME_INTERN(440, 9), /* ExtGState */
+    COS_NAME_INTERN(449, 9), /* FirstChar */
+    COS_NAME_INTERN(458, 9), /* FontFile2 */
+    COS_NAME_INTERN(467, 9), /* FontFile3 */
+    COS_NAME_INTERN(476, 9), /* Functions */
+    COS_NAME_INTERN(485, 9), /* ImageMask */
+    COS_NAME_INTERN(494, 9), /* JPXDecode */
+    COS_NAME_INTERN(503, 9), /* Predictor */
+    COS_NAME_INTERN(512, 9), /* Resources */
+    COS_NAME_INTERN(521, 9), /* ToUnicode */
+    COS_NAME_INTERN(530, 8), /* AvgWidth */
+    COS_NAME_INTERN(538, 8), /* BaseFont */
+    COS_NAME_INTERN(546, 8), /* Contents */
+    COS_NAME_INTERN(554, 8), /* Encoding */
+    COS_NAME_INTERN(562, 8), /* FontBBox */
+    COS_NAME_INTERN(570, 8), /* FontFile */
+    COS_NAME_INTERN(578, 8), /* FontName */
+    COS_NAME_INTERN(586, 8), /* FormType */
+    COS_NAME_INTERN(594, 8), /* Function */
+    COS_NAME_INTERN(602, 8), /* ICCBased */
+    COS_NAME_INTERN(610, 8), /* Identity */
+    COS_NAME_INTERN(618, 8), /* LastChar */
+    COS_NAME_INTERN(626, 8), /* MaxWidth */
+    COS_NAME_INTERN(634, 8), /* MediaBox */
+    COS_NAME_INTERN(642, 8), /* Metadata */
+    COS_NAME_INTERN(650, 8), /* Ordering */
+    COS_NAME_INTERN(658, 8), /* Outlines */
+    COS_NAME_INTERN(666, 8), /* PageMode */
+    COS_NAME_INTERN(674, 8), /* Producer */
+    COS_NAME_INTERN(682, 8), /* Registry */
+    COS_NAME_INTERN(690, 8), /* TrueType */
+    COS_NAME_INTERN(698, 7), /* CalGray */
+    COS_NAME_INTERN(705, 7), /* Catalog */
+    COS_NAME_INTERN(712, 7), /* CharSet */
+    COS_NAME_INTERN(719, 7), /* Columns */
+    COS_NAME_INTERN(726, 7), /* Creator */
+    COS_NAME_INTERN(733, 7), /* CropBox */
+    COS_NAME_INTERN(740, 7), /* Default */
+    COS_NAME_INTERN(747, 7), /* Descent */
+    COS_NAME_INTERN(754, 7), /* DeviceN */
+    COS_NAME_INTERN(761, 7), /* Encrypt */
+    COS_NAME_INTERN(768, 7), /* Indexed */
+    COS_NAME_INTERN(775, 7), /* Leading */
+    COS_NAME_INTERN(782, 7), /* Length1 */
+    COS_NAME_INTERN(789, 7), /* Length2 */
+    COS_NAME_INTERN(796, 7), /* Length3 */
+    COS_NAME_INTERN(803, 7), /* ModDate */
+    COS_NAME_INTERN(810, 7), /* Pattern */
+    COS_NAME_INTERN(817, 7), /* ProcSet */
+    COS_NAME_INTERN(824, 7), /* Procset */
+    COS_NAME_INTERN(831, 7), /* Shading */
+    COS_NAME_INTERN(838, 7), /* Subtype */
+    COS_NAME_INTERN(845, 7), /* TrimBox */
+    COS_NAME_INTERN(852, 7), /* Version */
+    COS_NAME_INTERN(859, 7), /* XHeight */
+    COS_NAME_INTERN(866, 7), /* XObject */
+    COS_NAME_INTERN(873, 7), /* XRefStm */
+    COS_NAME_INTERN(880, 6), /* Action */
+    COS_NAME_INTERN(886, 6), /* Annots */
+    COS_NAME_INTERN(892, 6), /* Ascent */
+    COS_NAME_INTERN(898, 6), /* Border */
+    COS_NAME_INTERN(904, 6), /* Bounds */
+    COS_NAME_INTERN(910, 6), /* CalRGB */
+    COS_NAME_INTERN(916, 6), /* Colors */
+    COS_NAME_INTERN(922, 6), /* Coords */
+    COS_NAME_INTERN(928, 6), /* Decode */
+    COS_NAME_INTERN(934, 6), /* Domain */
+    COS_NAME_INTERN(940, 6), /* Encode */
+    COS_NAME_INTERN(946, 6), /* Extend */
+    COS_NAME_INTERN(952, 6), /* Fields */
+    COS_NAME_INTERN(958, 6), /* Filter */
+    COS_NAME_INTERN(964, 6), /* Height */
+    COS_NAME_INTERN(970, 6), /* ImageB */
+    COS_NAME_INTERN(976, 6), /* ImageC */
+    COS_NAME_INTERN(982, 6), /* ImageI */
+    COS_NAME_INTERN(988, 6), /* Length */
+    COS_NAME_INTERN(994, 6), /* Limits */
+    COS_NAME_INTERN(1000, 6), /* Matrix */
+    COS_NAME_INTERN(1006, 6), /* Parent */
+    COS_NAME_INTERN(1012, 6), /* Rotate */
+    COS_NAME_INTERN(1018, 6), /* Widget */
+    COS_NAME_INTERN(1024, 6), /* Widths */
+    COS_NAME_INTERN(1030, 5), /* Annot */
+    COS_NAME_INTERN(1035, 5), /* Count */
+    COS_NAME_INTERN(1040, 5), /* Dests */
+    COS_NAME_INTERN(1045, 5), /* First */
+    COS_NAME_INTERN(1050, 5), /* Flags */
+    COS_NAME_INTERN(1055, 5), /* Group */
+    COS_NAME_INTERN(1060, 5), /* Image */
+    COS_NAME_INTERN(1065, 5), /* Index */
+    COS_NAME_INTERN(1070, 5), /* IsMap */
+    COS_NAME_INTERN(1075, 5), /* Names */
+    COS_NAME_INTERN(1080, 5), /* Pages */
+    COS_NAME_INTERN(1085, 5), /* Range */
+    COS_NAME_INTERN(1090, 5), /* SMask */
+    COS_NAME_INTERN(1095, 5), /* StemV */
+    COS_NAME_INTERN(1100, 5), /* Title */
+    COS_NAME_INTERN(1105, 5), /* Type0 */
+    COS_NAME_INTERN(1110, 5), /* Type1 */
+    COS_NAME_INTERN(1115, 5), /* Type3 */
+    COS_NAME_INTERN(1120, 5), /* Width */
+    COS_NAME_INTERN(1125, 4), /* BBox */
+    COS_NAME_INTERN(1129, 4), /* CMap */
+    COS_NAME_INTERN(1133, 4), /* Dest */
+    COS_NAME_INTERN(1137, 4), /* Font */
+    COS_NAME_INTERN(1141, 4), /* Form */
+    COS_NAME_INTERN(1145, 4), /* Info */
+    COS_NAME_INTERN(1149, 4), /* Kids */
+    COS_NAME_INTERN(1153, 4), /* Lang */
+    COS_NAME_INTERN(1157, 4), /* Last */
+    COS_NAME_INTERN(1161, 4), /* Link */
+    COS_NAME_INTERN(1165, 4), /* Mask */
+    COS_NAME_INTERN(1169, 4), /* Name */
+    COS_NAME_INTERN(1173, 4), /* Next */
+    COS_NAME_INTERN(1177, 4), /* OCGs */
+    COS_NAME_INTERN(1181, 4), /* Page */
+    COS_NAME_INTERN(1185, 4), /* Prev */
+    COS_NAME_INTERN(1189, 4), /* Rect */
+    COS_NAME_INTERN(1193, 4), /* Size */
+    COS_NAME_INTERN(1197, 4), /* Text */
+    COS_NAME_INTERN(1201, 4), /* Type */
+    COS_NAME_INTERN(1205, 4), /* XRef */
+    COS_NAME_INTERN(1209, 3), /* AIS */
+    COS_NAME_INTERN(1212, 3), /* Off */
+    COS_NAME_INTERN(1215, 3), /* URI */
+    COS_NAME_INTERN(1218, 2), /* AA */
+    COS_NAME_INTERN(1220, 2), /* AP */
+    COS_NAME_INTERN(1222, 2), /* AS */
+    COS_NAME_INTERN(1224, 2), /* BM */
+    COS_NAME_INTERN(1226, 2), /* BS */
+    COS_NAME_INTERN(1228, 2), /* CA */
+    COS_NAME_INTERN(1230, 2), /* CF */
+    COS_NAME_INTERN(1232, 2), /* CS */
+    COS_NAME_INTERN(1234, 2), /* DA */
+    COS_NAME_INTERN(1236, 2), /* DL */
+    COS_NAME_INTERN(1238, 2), /* DR */
+    COS_NAME_INTERN(1240, 2), /* DW */
+    COS_NAME_INTERN(1242, 2), /* FT */
+    COS_NAME_INTERN(1244, 2), /* Ff */
+    COS_NAME_INTERN(1246, 2), /* ID */
+    COS_NAME_INTERN(1248, 2), /* JS */
+    COS_NAME_INTERN(1250, 2), /* LW */
+    COS_NAME_INTERN(1252, 2), /* OC */
+    COS_NAME_INTERN(1254, 2), /* On */
+    COS_NAME_INTERN(1256, 2), /* SA */
+    COS_NAME_INTERN(1258, 2), /* SM */
+    COS_NAME_INTERN(1260, 2), /* TR */
+    COS_NAME_INTERN(1262, 2), /* W2 */
+    COS_NAME_INTERN(1264, 1), /* A */
+    COS_NAME_INTERN(1265, 1), /* B */
+    COS_NAME_INTERN(1266, 1), /* C */
+    COS_NAME_INTERN(1267, 1), /* D */
+    COS_NAME_INTERN(1268, 1), /* E */
+    COS_NAME_INTERN(1269, 1), /* F */
+    COS_NAME_INTERN(1270, 1), /* G */
+    COS_NAME_INTERN(1271, 1), /* H */
+    COS_NAME_INTERN(1272, 1), /* I */
+    COS_NAME_INTERN(1273, 1), /* K */
+    COS_NAME_INTERN(1274, 1), /* L */
+    COS_NAME_INTERN(1275, 1), /* M */
+    COS_NAME_INTERN(1276, 1), /* N */
+    COS_NAME_INTERN(1277, 1), /* O */
+    COS_NAME_INTERN(1278, 1), /* P */
+    COS_NAME_INTERN(1279, 1), /* Q */
+    COS_NAME_INTERN(1280, 1), /* R */
+    COS_NAME_INTERN(1281, 1), /* S */
+    COS_NAME_INTERN(1282, 1), /* T */
+    COS_NAME_INTERN(1283, 1), /* U */
+    COS_NAME_INTERN(1284, 1), /* V */
+    COS_NAME_INTERN(1285, 1), /* W */
+    COS_NAME_INTERN(1286, 1), /* X */
+};
+
+#define COS_NAME_INTERN_COUNT (sizeof(_intern_names) / sizeof(_intern_names[0]))
+
+#endif
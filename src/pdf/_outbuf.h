@@ -0,0 +1,28 @@
+#ifndef PDF__OUTBUF_H_
+#define PDF__OUTBUF_H_
+
+/* A growable output buffer, for the filters */
+
+#define PDF_OUTBUF_CHUNK 16384
+
+typedef struct {
+  uint8_t *buf;
+  size_t len;
+  size_t size;
+} _OutBuf;
+
+/* make room for n more bytes */
+static inline int _reserve(_OutBuf *out, size_t n) {
+  if (out->len + n > out->size) {
+    size_t size = out->size ? out->size : PDF_OUTBUF_CHUNK;
+    uint8_t *buf;
+    while (size < out->len + n) size *= 2;
+    buf = realloc(out->buf, size);
+    if (buf == NULL) return -1;
+    out->buf = buf;
+    out->size = size;
+  }
+  return 0;
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef PDF__SIMD_H_
+#define PDF__SIMD_H_
+
+/* SIMD feature selection. PDF_SSE2 is defined when SSE2 is available at
+ * compile time (always, on x86-64). PDF_AVX2 is defined when the compiler
+ * can target AVX2 per-function; use _have_avx2() to check the CPU at runtime.
+ * Define PDF_NO_SIMD to build the scalar code only. */
+
+#if !defined(PDF_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define PDF_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PDF_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
+/* lowest and highest set bits of a non-zero mask */
+#if defined(_MSC_VER)
+#include <intrin.h>
+static inline unsigned _ctz(uint32_t m) { unsigned long i; _BitScanForward(&i, m); return i; }
+static inline unsigned _msb(uint32_t m) { unsigned long i; _BitScanReverse(&i, m); return i; }
+#else
+#define _ctz(m) ((unsigned) __builtin_ctz(m))
+#define _msb(m) (31 - (unsigned) __builtin_clz(m))
+#endif
+
+#ifdef PDF_AVX2
+
+#define PDF_TARGET_AVX2 __attribute__((target("avx2")))
+
+static inline int _have_avx2(void) {
+    static int have = -1;
+    if (have < 0) {
+        __builtin_cpu_init();
+        have = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+    return have;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef PDF__THREAD_H_
+#define PDF__THREAD_H_
+
+/* Minimal threads: POSIX threads, or the Win32 API. Thread functions are
+ * declared with _THREAD_FUNC(name) and end with _THREAD_RETURN. */
+
+#ifdef _WIN32
+#include <windows.h>
+
+typedef HANDLE _thread_t;
+#define _THREAD_FUNC(name) static DWORD WINAPI name(LPVOID arg)
+#define _THREAD_RETURN return 0
+
+static int _thread_create(_thread_t* t, LPTHREAD_START_ROUTINE func, void* arg) {
+    *t = CreateThread(NULL, 0, func, arg, 0, NULL);
+    return *t ? 0 : -1;
+}
+
+static void _thread_join(_thread_t t) {
+    WaitForSingleObject(t, INFINITE);
+    CloseHandle(t);
+}
+
+#else
+#include <pthread.h>
+
+typedef pthread_t _thread_t;
+#define _THREAD_FUNC(name) static void* name(void* arg)
+#define _THREAD_RETURN return NULL
+
+static inline int _thread_create(_thread_t* t, void* (*func)(void*), void* arg) {
+    return pthread_create(t, NULL, func, arg) ? -1 : 0;
+}
+
+static inline void _thread_join(_thread_t t) {
+    pthread_join(t, NULL);
+}
+
+#endif
+
+#endif
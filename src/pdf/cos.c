@@ -2,12 +2,202 @@
 #include "pdf/cos.h"
 #include "pdf/write.h"
 #include "pdf/_bufcat.h"
+#include "pdf/_atomic.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <inttypes.h>
 
-#define COS_CHECK_SUM(n) ((n)->type + 123)
+#define COS_TYPE_CHECK_SUM(t) ((t) + 123)
+#define COS_CHECK_SUM(n) COS_TYPE_CHECK_SUM((n)->type)
+
+#include "pdf/_cos_names.h"
+
+/* arena allocations are aligned to this */
+#define COS_ARENA_ALIGN 8
+#define COS_ARENA_ALIGNED(n) (((n) + COS_ARENA_ALIGN - 1) & ~((size_t)COS_ARENA_ALIGN - 1))
+#define COS_ARENA_BLOCK_SIZE 65536
+
+typedef struct _CosArenaBlock {
+    struct _CosArenaBlock* next;
+    size_t size;
+    size_t used;
+} CosArenaBlock;
+
+#define COS_ARENA_BLOCK_HDR COS_ARENA_ALIGNED(sizeof(CosArenaBlock))
+
+struct _CosArena {
+    CosArenaBlock* blocks;
+    size_t block_size;
+    /* nodes that may later acquire heap buffers (dict indices,
+       attached stream data), which are freed with the arena */
+    CosNode** finalize;
+    size_t n_finalize;
+    size_t finalize_size;
+};
+
+DLLEXPORT CosArena* cos_arena_new(size_t block_size) {
+    CosArena* self = malloc(sizeof(CosArena));
+    self->blocks = NULL;
+    self->block_size = block_size ? COS_ARENA_ALIGNED(block_size) : COS_ARENA_BLOCK_SIZE;
+    self->finalize = NULL;
+    self->n_finalize = 0;
+    self->finalize_size = 0;
+    return self;
+}
+
+DLLEXPORT void* cos_arena_alloc(CosArena* self, size_t size) {
+    CosArenaBlock* block = self->blocks;
+    void* p;
+
+    size = COS_ARENA_ALIGNED(size);
+
+    if (block == NULL || block->used + size > block->size) {
+        size_t block_size = size > self->block_size ? size : self->block_size;
+        CosArenaBlock* new_block = malloc(COS_ARENA_BLOCK_HDR + block_size);
+        if (new_block == NULL) return NULL;
+        new_block->size = block_size;
+        new_block->used = 0;
+
+        if (block && size * 4 > self->block_size) {
+            /* oversized; keep the current block for smaller allocations */
+            new_block->next = block->next;
+            block->next = new_block;
+        }
+        else {
+            new_block->next = block;
+            self->blocks = new_block;
+        }
+        block = new_block;
+    }
+
+    p = (char*)block + COS_ARENA_BLOCK_HDR + block->used;
+    block->used += size;
+    return p;
+}
+
+static void _arena_finalize(CosArena* self, CosNode* node) {
+    if (self->n_finalize >= self->finalize_size) {
+        self->finalize_size = self->finalize_size ? self->finalize_size * 2 : 16;
+        self->finalize = realloc(self->finalize, self->finalize_size * sizeof(CosNode*));
+    }
+    self->finalize[self->n_finalize++] = node;
+}
+
+DLLEXPORT void cos_arena_done(CosArena* self) {
+    CosArenaBlock* block = self->blocks;
+    size_t i;
+
+    for (i = 0; i < self->n_finalize; i++) {
+        CosNode* node = self->finalize[i];
+        switch (node->type) {
+        case COS_NODE_DICT:
+            if (((CosDict*)node)->index) free(((CosDict*)node)->index);
+            if (((CosDict*)node)->hash) free(((CosDict*)node)->hash);
+            break;
+        case COS_NODE_LIT_STR:
+        case COS_NODE_HEX_STR:
+        case COS_NODE_STREAM:
+        case COS_NODE_INLINE_IMAGE:
+            /* heap data, attached or materialized */
+            if (!(node->flags & COS_NODE_FLAG_BORROWED)) {
+                void* value = node->type == COS_NODE_LIT_STR || node->type == COS_NODE_HEX_STR
+                    ? (void*) ((struct CosStringyNode*)node)->value
+                    : (void*) ((CosStream*)node)->value;
+                if (value) free(value);
+            }
+            break;
+        }
+    }
+    if (self->finalize) free(self->finalize);
+
+    while (block) {
+        CosArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+
+    free(self);
+}
+
+static void* _alloc(CosArena* arena, size_t size) {
+    return arena ? cos_arena_alloc(arena, size) : malloc(size);
+}
+
+/* arena containers don't hold references on their members */
+static void _member_reference(CosArena* arena, CosNode* member) {
+    if (!arena) cos_node_reference(member);
+}
+
+static void* _node_new(CosArena* arena, size_t size, CosNodeType type) {
+    CosNode* self = _alloc(arena, size);
+    self->type = type;
+    self->check_sum = COS_CHECK_SUM(self);
+    self->flags = arena ? COS_NODE_FLAG_ARENA : 0;
+    self->ref_count = 1;
+    return self;
+}
+
+/* take a heap copy of a borrowed payload */
+static void _materialize_value(CosNode* self) {
+    if (!(self->flags & COS_NODE_FLAG_BORROWED)) return;
+
+    switch ((CosNodeType)self->type) {
+    case COS_NODE_LIT_STR:
+    case COS_NODE_HEX_STR:
+    case COS_NODE_COMMENT:
+        {
+            struct CosStringyNode* s = (void*)self;
+            PDF_TYPE_STRING value = malloc(s->value_len);
+            if (s->value_len) memcpy(value, s->value, s->value_len);
+            s->value = value;
+        }
+        break;
+    case COS_NODE_STREAM:
+    case COS_NODE_INLINE_IMAGE:
+        {
+            struct CosStreamish* s = (void*)self;
+            char* value = malloc(s->value_len);
+            if (s->value_len) memcpy(value, s->value, s->value_len);
+            s->value = value;
+        }
+        break;
+    default:
+        break;
+    }
+
+    self->flags &= ~COS_NODE_FLAG_BORROWED;
+}
+
+DLLEXPORT void cos_node_materialize(CosNode* self) {
+    if (self == NULL) return;
+
+    switch ((CosNodeType)self->type) {
+    case COS_NODE_OP:
+    case COS_NODE_CONTENT:
+    case COS_NODE_ARRAY:
+    case COS_NODE_DICT:
+        {
+            struct CosContainerNode* c = (void*)self;
+            size_t i;
+            for (i=0; i < c->elems; i++) {
+                cos_node_materialize(c->values[i]);
+            }
+        }
+        break;
+    case COS_NODE_IND_OBJ:
+        cos_node_materialize(((CosIndObj*)self)->value);
+        break;
+    case COS_NODE_STREAM:
+    case COS_NODE_INLINE_IMAGE:
+        cos_node_materialize((CosNode*)((struct CosStreamish*)self)->dict);
+        _materialize_value(self);
+        break;
+    default:
+        _materialize_value(self);
+        break;
+    }
+}
 
 DLLEXPORT void cos_node_reference(CosNode* self) {
     if (self == NULL) return;
@@ -15,18 +205,27 @@ DLLEXPORT void cos_node_reference(CosNode* self) {
         fprintf(stderr, __FILE__ ":%d node %p (type %d) not owned by us or corrupted\n", __LINE__, (void*) self, self->type);
         return;
     }
-    self->ref_count++;
+    if (self->flags & (COS_NODE_FLAG_ARENA|COS_NODE_FLAG_INTERNED)) return;
+    _atomic_fetch_inc(&self->ref_count);
 }
 
 DLLEXPORT void cos_node_done(CosNode* self) {
+    uint32_t ref_count;
     if (self == NULL) return;
     if (self->check_sum != COS_CHECK_SUM(self)) {
         fprintf(stderr, __FILE__ ":%d node %p (type %d, ref %d) not owned by us or corrupted\n", __LINE__, (void*) self, self->type, self->ref_count);
     }
-    else if (self->ref_count == 0) {
+    else if (self->flags & COS_NODE_FLAG_ARENA) {
+        /* released with the arena */
+    }
+    else if (self->flags & COS_NODE_FLAG_INTERNED) {
+        /* shared and never released */
+    }
+    else if ((ref_count = _atomic_fetch_dec(&self->ref_count)) == 0) {
+        _atomic_fetch_inc(&self->ref_count);
         fprintf(stderr, __FILE__ ":%d node was not referenced: %p\n", __LINE__, (void*) self);
     }
-    else if (--(self->ref_count) <= 0) {
+    else if (ref_count == 1) {
         switch ((CosNodeType)self->type) {
         case COS_NODE_ANY:
         case COS_NODE_BOOL:
@@ -42,7 +241,9 @@ DLLEXPORT void cos_node_done(CosNode* self) {
         case COS_NODE_LIT_STR:
         case COS_NODE_HEX_STR:
         case COS_NODE_COMMENT:
-            free(((struct CosStringyNode*)self)->value);
+            if (!(self->flags & COS_NODE_FLAG_BORROWED)) {
+                free(((struct CosStringyNode*)self)->value);
+            }
             break;
         case COS_NODE_OP:
             free(((CosOp*)self)->opn);
@@ -65,6 +266,7 @@ DLLEXPORT void cos_node_done(CosNode* self) {
                 if (d) {
                     free(d->keys);
                     if (d->index) free(d->index);
+                    if (d->hash) free(d->hash);
                 }
             }
             break;
@@ -76,7 +278,9 @@ DLLEXPORT void cos_node_done(CosNode* self) {
             {
                 struct CosStreamish* stream = (void*)self;
                 cos_node_done((CosNode*)stream->dict);
-                if (stream->value) free(stream->value);
+                if (stream->value && !(self->flags & COS_NODE_FLAG_BORROWED)) {
+                    free(stream->value);
+                }
             }
             break;
         }
@@ -171,7 +375,7 @@ DLLEXPORT int cos_node_cmp(CosNode* self, CosNode* obj) {
             case COS_NODE_NULL:
                 return COS_CMP_EQUAL;
             case COS_NODE_REAL:
-                return COS_CMP(((CosReal*)self)->value, ((CosInt*)obj)->value);
+                return COS_CMP(((CosReal*)self)->value, ((CosReal*)obj)->value);
             case COS_NODE_REF:
             {
                 CosRef* a = (void*)self;
@@ -224,14 +428,16 @@ DLLEXPORT int cos_node_cmp(CosNode* self, CosNode* obj) {
             {
                 CosDict* a = (void*)self;
                 CosDict* b = (void*)obj;
+                size_t* a_index = cos_dict_build_index(a);
+                size_t* b_index = cos_dict_build_index(b);
+                /* sizes are stored atomically, alongside the tables */
+                size_t len = _atomic_load_size(&a->index_len);
                 int rv = COS_CMP_EQUAL;
                 size_t i;
-                if (!a->index) cos_dict_build_index(a);
-                if (!b->index) cos_dict_build_index(b);
-                if (a->index_len != b->index_len) return COS_CMP_DIFFERENT;
-                for (i = 0; i < a->index_len; i++) {
-                    size_t ai = a->index[ i ];
-                    size_t bi = b->index[ i ];
+                if (len != _atomic_load_size(&b->index_len)) return COS_CMP_DIFFERENT;
+                for (i = 0; i < len; i++) {
+                    size_t ai = a_index[ i ];
+                    size_t bi = b_index[ i ];
                     if (ai != bi) rv = COS_CMP_SIMILAR; /* keys in different order */
                     if (cos_node_cmp((CosNode*)a->keys[ai], (CosNode*)b->keys[bi])) return COS_CMP_DIFFERENT;
                     {
@@ -327,16 +533,22 @@ static int _node_write(CosNode* self, char* out, int out_len, int indent) {
 
 
 DLLEXPORT CosArray* cos_array_new(CosNode** values, size_t elems) {
+    return cos_array_new_in(NULL, values, elems);
+}
+
+DLLEXPORT CosArray* cos_array_new_in(CosArena* arena, CosNode** values, size_t elems) {
     size_t i;
-    CosArray* self = malloc(sizeof(CosArray));
-    self->type = COS_NODE_ARRAY;
-    self->check_sum = COS_CHECK_SUM(self);
-    self->ref_count = 1;
+    CosArray* self = _node_new(arena, sizeof(CosArray), COS_NODE_ARRAY);
     self->elems = elems;
-    self->values = malloc(sizeof(CosNode*) * elems);
-    for (i=0; i < elems; i++) {
-        self->values[i] = values[i];
-        cos_node_reference(values[i]);
+    self->values = _alloc(arena, sizeof(CosNode*) * elems);
+    if (values) {
+        for (i=0; i < elems; i++) {
+            self->values[i] = values[i];
+            _member_reference(arena, values[i]);
+        }
+    }
+    else {
+        memset(self->values, 0, elems * sizeof(CosNode*));
     }
     return self;
 }
@@ -361,101 +573,192 @@ DLLEXPORT size_t cos_array_write(CosArray* self, char* out, size_t out_len, int
 }
 
 DLLEXPORT CosDict* cos_dict_new(CosName** keys, CosNode** values, size_t elems) {
+    return cos_dict_new_in(NULL, keys, values, elems);
+}
+
+DLLEXPORT CosDict* cos_dict_new_in(CosArena* arena, CosName** keys, CosNode** values, size_t elems) {
     size_t i;
-    CosDict* self = malloc(sizeof(CosDict));
-    self->type = COS_NODE_DICT;
-    self->check_sum = COS_CHECK_SUM(self);
-    self->ref_count = 1;
+    CosDict* self = _node_new(arena, sizeof(CosDict), COS_NODE_DICT);
     self->elems = elems;
-    self->keys   = malloc(sizeof(CosName*) * elems);
-    self->values = malloc(sizeof(CosNode*) * elems);
-    for (i=0; i < elems; i++) {
-        self->keys[i] = keys[i];
-        cos_node_reference((CosNode*)keys[i]);
+    self->keys   = _alloc(arena, sizeof(CosName*) * elems);
+    self->values = _alloc(arena, sizeof(CosNode*) * elems);
+    if (keys && values) {
+        for (i=0; i < elems; i++) {
+            self->keys[i] = keys[i];
+            _member_reference(arena, (CosNode*)keys[i]);
 
-        self->values[i] = values[i];
-        cos_node_reference(values[i]);
+            self->values[i] = values[i];
+            _member_reference(arena, values[i]);
+        }
+    }
+    else {
+        memset(self->keys, 0, elems * sizeof(CosName*));
+        memset(self->values, 0, elems * sizeof(CosNode*));
     }
     self->index = NULL;
     self->index_len = 0;
+    self->hash = NULL;
+    self->hash_size = 0;
+    if (arena) _arena_finalize(arena, (CosNode*)self);
 
     return self;
 }
 
+static int _cmp_name_value(PDF_TYPE_CODE_POINTS value, uint16_t value_len, CosName* n) {
+    if (value_len != n->value_len) {
+        return value_len > n->value_len ? -1 : 1;
+    }
+    return _cmp_code_points(value, n->value, value_len);
+}
+
 /* sorting comparision */
 static int _cmp_names(CosName* n1, CosName* n2) {
-    if (!n1 || !n2 || n1->type != COS_NODE_NAME || n1->type != COS_NODE_NAME) {
+    if (n1 == n2) {
+        /* includes interned names */
         return 0;
     }
-    else if (n1->value_len != n2->value_len) {
-        return n1->value_len > n2->value_len ? -1 : 1;
+    else if (!n1 || !n2 || n1->type != COS_NODE_NAME || n2->type != COS_NODE_NAME) {
+        return 0;
     }
-    return _cmp_code_points(n1->value, n2->value, n1->value_len);
+    return _cmp_name_value(n1->value, n1->value_len, n2);
 }
 
-DLLEXPORT CosNode* cos_dict_lookup(CosDict* self, CosName* key) {
-    size_t low, high;
-    size_t* index = self->index;
+static int _names_equal(CosName* n1, CosName* n2) {
+    return n1 == n2
+        || (n1 && n2 && n1->value_len == n2->value_len
+            && !_cmp_code_points(n1->value, n2->value, n1->value_len));
+}
+
+/* FNV-1a, over code points */
+static size_t _hash_name(CosName* n) {
+    uint32_t h = 2166136261u;
+    uint16_t i;
+    for (i = 0; i < n->value_len; i++) {
+        h ^= n->value[i];
+        h *= 16777619u;
+    }
+    return h;
+}
 
-    if (!self->elems) return NULL;
+/* Open-addressed table of entry positions, offset by one. Null values are
+   left out. The last of any duplicate keys wins, as with .ast(). Built
+   privately, then published once, so concurrent readers are safe. */
+static size_t* _dict_build_hash(CosDict* self) {
+    size_t size = COS_DICT_HASH_MIN * 2;
+    size_t mask;
+    size_t* hash;
+    size_t* published;
+    size_t i;
 
-    if (!index) index = cos_dict_build_index(self);
+    while (size < self->elems * 2) size *= 2;
+    mask = size - 1;
 
-    for (low = 0, high = self->index_len;;) {
-        size_t mid = low + (high - low) / 2;
-        CosName* this_key = self->keys[ index[mid] ];
-        int cmp = _cmp_names(key, this_key);
+    hash = calloc(size, sizeof(size_t));
 
-        if (cmp == 0) {
-            return self->values[ index[mid] ];
-        }
-        else if (low >= high-1) {
-            break;
+    for (i = 0; i < self->elems; i++) {
+        CosName* key = self->keys[i];
+        size_t h;
+
+        if (!key || self->values[i]->type == COS_NODE_NULL) continue;
+
+        for (h = _hash_name(key) & mask;
+             hash[h] && !_names_equal(key, self->keys[ hash[h] - 1 ]);
+             h = (h + 1) & mask) {
         }
-        else if (cmp < 0) {
-            high = mid;
+        hash[h] = i + 1;
+    }
+
+    /* any competing thread computes the same size */
+    _atomic_store_size(&self->hash_size, size);
+    published = _atomic_publish_ptr((void**) &self->hash, hash);
+    if (published != hash) free(hash);
+
+    return published;
+}
+
+DLLEXPORT CosNode* cos_dict_lookup(CosDict* self, CosName* key) {
+    if (!self->elems || !key) return NULL;
+
+    if (self->elems < COS_DICT_HASH_MIN) {
+        /* small; scan it */
+        size_t i;
+        for (i = self->elems; i-- > 0;) {
+            if (_names_equal(key, self->keys[i]) && self->values[i]->type != COS_NODE_NULL) {
+                return self->values[i];
+            }
         }
-        else {
-            low = mid;
+    }
+    else {
+        size_t* hash = _atomic_load_ptr((void**) &self->hash);
+        size_t mask;
+        size_t h;
+
+        if (!hash) hash = _dict_build_hash(self);
+        /* may be concurrently stored, by a competing build */
+        mask = _atomic_load_size(&self->hash_size) - 1;
+
+        for (h = _hash_name(key) & mask; hash[h]; h = (h + 1) & mask) {
+            if (_names_equal(key, self->keys[ hash[h] - 1 ])) {
+                return self->values[ hash[h] - 1 ];
+            }
         }
     }
     return NULL;
 }
 
+/* Built privately, then published once, so concurrent readers are safe. */
 DLLEXPORT size_t* cos_dict_build_index(CosDict* self) {
+    size_t* index = _atomic_load_ptr((void**) &self->index);
+    size_t* published;
+    size_t len = 0;
     size_t i;
 
-    if (self->index) return self->index;
+    if (index) return index;
 
-    self->index = malloc(self->elems * sizeof(size_t) );
-    self->index_len = 0;
+    index = malloc(self->elems * sizeof(size_t) );
 
     /* pass 1: sequence, ignoring nulls */
     for (i = 0; i < self->elems; i++) {
         if (self->values[i]->type != COS_NODE_NULL) {
-            self->index[ self->index_len++ ] = i;
+            index[ len++ ] = i;
         }
     }
-    /* pass 2: stable sort */
-    {
-        int sorted = 0;
-        size_t len = self->index_len;
-        while (len > 1 && !sorted) {
-            sorted = 1;
-            for (i = 1; i < len; i++) {
-                int cmp = _cmp_names(self->keys[ self->index[i-1] ], self->keys[ self->index[i] ]);
-                if (cmp > 0) {
-                    size_t tmp = self->index[i];
-                    self->index[i] = self->index[i-1];
-                    self->index[i-1] = tmp;
-                    sorted = 0;
+    /* pass 2: stable bottom-up merge sort */
+    if (len > 1) {
+        size_t* src = index;
+        size_t* dst = malloc(len * sizeof(size_t));
+        size_t width;
+
+        for (width = 1; width < len; width *= 2) {
+            size_t lo;
+            for (lo = 0; lo < len; lo += 2 * width) {
+                size_t mid = lo + width < len ? lo + width : len;
+                size_t hi = mid + width < len ? mid + width : len;
+                size_t a = lo, b = mid, k = lo;
+                while (a < mid && b < hi) {
+                    dst[k++] = _cmp_names(self->keys[ src[b] ], self->keys[ src[a] ]) < 0
+                        ? src[b++] : src[a++];
                 }
+                while (a < mid) dst[k++] = src[a++];
+                while (b < hi) dst[k++] = src[b++];
+            }
+            {
+                size_t* tmp = src; src = dst; dst = tmp;
             }
-            len--;
         }
+
+        if (src != index) {
+            memcpy(index, src, len * sizeof(size_t));
+        }
+        free(src == index ? dst : src);
     }
 
-    return self->index;
+    /* any competing thread computes the same length */
+    _atomic_store_size(&self->index_len, len);
+    published = _atomic_publish_ptr((void**) &self->index, index);
+    if (published != index) free(index);
+
+    return published;
 }
 
 static size_t _indent_items(CosDict* self, char *out, size_t out_len, size_t* pos, int indent) {
@@ -532,35 +835,52 @@ bail:
 }
 
 DLLEXPORT CosRef* cos_ref_new(uint64_t obj_num, uint32_t gen_num) {
-    CosRef* self = malloc(sizeof(CosRef));
-    self->type = COS_NODE_REF;
-    self->check_sum = COS_CHECK_SUM(self);
-    self->ref_count = 1;
+    return cos_ref_new_in(NULL, obj_num, gen_num);
+}
+
+DLLEXPORT CosRef* cos_ref_new_in(CosArena* arena, uint64_t obj_num, uint32_t gen_num) {
+    CosRef* self = _node_new(arena, sizeof(CosRef), COS_NODE_REF);
     self->obj_num = obj_num;
     self->gen_num = gen_num;
     return self;
 }
 
+/* writes '<obj-num> <gen-num>', followed by a suffix; e.g. " R" */
+static size_t _obj_id_write(uint64_t obj_num, uint32_t gen_num, char* suffix, char* out, size_t out_len) {
+    size_t n, m;
+
+    n = pdf_write_int((PDF_TYPE_INT64)obj_num, out, out_len);
+    if (n == 0 || n >= out_len) return 0;
+    out[n++] = ' ';
+    n += (m = pdf_write_int(gen_num, out+n, out_len-n));
+    if (m == 0) return 0;
+    n += (m = _bufcat(out+n, out_len-n, suffix));
+
+    return m ? n : 0;
+}
+
 DLLEXPORT size_t cos_ref_write(CosRef* self, char* out, size_t out_len) {
-    return snprintf(out, out_len, "%" PRId64 " %d R", self->obj_num, self->gen_num);
+    return _obj_id_write(self->obj_num, self->gen_num, " R", out, out_len);
 }
 
 DLLEXPORT CosIndObj* cos_ind_obj_new(uint64_t obj_num, uint32_t gen_num, CosNode* value) {
-    CosIndObj* self = malloc(sizeof(CosIndObj));
-    self->type = COS_NODE_IND_OBJ;
-    self->check_sum = COS_CHECK_SUM(self);
-    self->ref_count = 1;
+    return cos_ind_obj_new_in(NULL, obj_num, gen_num, value);
+}
+
+DLLEXPORT CosIndObj* cos_ind_obj_new_in(CosArena* arena, uint64_t obj_num, uint32_t gen_num, CosNode* value) {
+    CosIndObj* self = _node_new(arena, sizeof(CosIndObj), COS_NODE_IND_OBJ);
     self->obj_num = obj_num;
     self->gen_num = gen_num;
     self->value = value;
-    cos_node_reference(value);
+    _member_reference(arena, value);
     return self;
 }
 
 DLLEXPORT size_t cos_ind_obj_write(CosIndObj* self, char* out, size_t out_len) {
     size_t n = 0;
     size_t m;
-    n = snprintf(out, out_len, "%" PRId64 " %d obj\n", self->obj_num, self->gen_num);
+    n = _obj_id_write(self->obj_num, self->gen_num, " obj\n", out, out_len);
+    if (n == 0) return 0;
     n += (m = _node_write(self->value, out+n, out_len-n, 0));
     if (m == 0) return 0;
     n += (m = _bufcat(out+n, out_len-n, "\nendobj\n"));
@@ -574,6 +894,7 @@ static void _crypt_node(CosNode* self, CosCryptNodeCtx* crypt_ctx) {
         case COS_NODE_HEX_STR:
             if (crypt_ctx->mode != COS_CRYPT_ONLY_STREAMS) {
                 struct CosStringyNode* s = (void*) self;
+                _materialize_value(self);
                 crypt_ctx->crypt_cb(crypt_ctx, s->value, s->value_len);
             }
             break;
@@ -593,6 +914,7 @@ static void _crypt_node(CosNode* self, CosCryptNodeCtx* crypt_ctx) {
                 _crypt_node((CosNode*)s->dict, crypt_ctx);
 
                 if (crypt_ctx->mode != COS_CRYPT_ONLY_STRINGS) {
+                    _materialize_value(self);
                     crypt_ctx->crypt_cb(crypt_ctx, s->value, s->value_len);
                 }
             }
@@ -631,27 +953,49 @@ DLLEXPORT void cos_ind_obj_crypt(CosIndObj* self, CosCryptNodeCtx* crypt_ctx) {
     crypt_ctx->gen_num = 0;
 }
 
-DLLEXPORT CosStream* cos_stream_new(CosDict* dict, unsigned char* value, size_t value_len) {
-    CosStream* self = malloc(sizeof(CosStream));
-    self->type = COS_NODE_STREAM;
-    self->check_sum = COS_CHECK_SUM(self);
-    self->ref_count = 1;
+static CosStream* _stream_new(CosArena* arena, CosDict* dict, unsigned char* value, size_t value_len, int borrow) {
+    CosStream* self = _node_new(arena, sizeof(CosStream), COS_NODE_STREAM);
     self->dict = dict;
-    cos_node_reference((CosNode*)dict);
+    _member_reference(arena, (CosNode*)dict);
 
-    if (value) {
-        self->value = malloc(value_len);
+    if (value && borrow) {
+        self->value = (char*) value;
+        self->value_len = value_len;
+        self->flags |= COS_NODE_FLAG_BORROWED;
+        /* may be materialized later, to the heap */
+        if (arena) _arena_finalize(arena, (CosNode*)self);
+    }
+    else if (value) {
+        self->value = _alloc(arena, value_len);
         memcpy(self->value, value, value_len);
         self->value_len = value_len;
     }
     else {
+        /* data may be attached later, from the heap */
         self->value = NULL;
         self->value_pos = value_len;
+        if (arena) _arena_finalize(arena, (CosNode*)self);
     }
 
     return self;
 }
 
+DLLEXPORT CosStream* cos_stream_new(CosDict* dict, unsigned char* value, size_t value_len) {
+    return _stream_new(NULL, dict, value, value_len, 0);
+}
+
+DLLEXPORT CosStream* cos_stream_new_in(CosArena* arena, CosDict* dict, unsigned char* value, size_t value_len) {
+    return _stream_new(arena, dict, value, value_len, 0);
+}
+
+DLLEXPORT CosStream* cos_stream_borrow(CosDict* dict, unsigned char* value, size_t value_len) {
+    return _stream_new(NULL, dict, value, value_len, 1);
+}
+
+DLLEXPORT CosStream* cos_stream_borrow_in(CosArena* arena, CosDict* dict, unsigned char* value, size_t value_len) {
+    return _stream_new(arena, dict, value, value_len, 1);
+}
+
 /* continue read from parse buffer, attaching stream data */
 DLLEXPORT int cos_stream_attach_data(CosStream* self, unsigned char* buf, size_t buf_len, size_t value_len) {
     if (self->value) return -1;
@@ -662,6 +1006,16 @@ DLLEXPORT int cos_stream_attach_data(CosStream* self, unsigned char* buf, size_t
     return 1;
 }
 
+/* continue read from parse buffer, referencing stream data */
+DLLEXPORT int cos_stream_borrow_data(CosStream* self, unsigned char* buf, size_t buf_len, size_t value_len) {
+    if (self->value) return -1;
+    if (self->value_pos + value_len > buf_len) return -1;
+    self->value = (char*) buf + self->value_pos;
+    self->value_len = value_len;
+    self->flags |= COS_NODE_FLAG_BORROWED;
+    return 1;
+}
+
 DLLEXPORT size_t cos_stream_write(CosStream* self, char* out, size_t out_len) {
     size_t m;
     size_t n = cos_dict_write(self->dict, out, out_len, 0);
@@ -683,10 +1037,11 @@ DLLEXPORT size_t cos_stream_write(CosStream* self, char* out, size_t out_len) {
 }
 
 DLLEXPORT CosInt* cos_int_new(PDF_TYPE_INT value) {
-    CosInt* self = malloc(sizeof(CosInt));
-    self->type = COS_NODE_INT;
-    self->check_sum = COS_CHECK_SUM(self);
-    self->ref_count = 1;
+    return cos_int_new_in(NULL, value);
+}
+
+DLLEXPORT CosInt* cos_int_new_in(CosArena* arena, PDF_TYPE_INT value) {
+    CosInt* self = _node_new(arena, sizeof(CosInt), COS_NODE_INT);
     self->value = value;
     return self;
 }
@@ -696,10 +1051,11 @@ DLLEXPORT size_t cos_int_write(CosInt* self, char* out, size_t out_len) {
 }
 
 DLLEXPORT CosBool* cos_bool_new(PDF_TYPE_BOOL value) {
-    CosBool* self = malloc(sizeof(CosBool));
-    self->type = COS_NODE_BOOL;
-    self->check_sum = COS_CHECK_SUM(self);
-    self->ref_count = 1;
+    return cos_bool_new_in(NULL, value);
+}
+
+DLLEXPORT CosBool* cos_bool_new_in(CosArena* arena, PDF_TYPE_BOOL value) {
+    CosBool* self = _node_new(arena, sizeof(CosBool), COS_NODE_BOOL);
     self->value = value;
     return self;
 }
@@ -709,10 +1065,11 @@ DLLEXPORT size_t cos_bool_write(CosBool* self, char* out, size_t out_len) {
 }
 
 DLLEXPORT CosReal* cos_real_new(PDF_TYPE_REAL value) {
-    CosReal* self = malloc(sizeof(CosReal));
-    self->type = COS_NODE_REAL;
-    self->check_sum = COS_CHECK_SUM(self);
-    self->ref_count = 1;
+    return cos_real_new_in(NULL, value);
+}
+
+DLLEXPORT CosReal* cos_real_new_in(CosArena* arena, PDF_TYPE_REAL value) {
+    CosReal* self = _node_new(arena, sizeof(CosReal), COS_NODE_REAL);
     self->value = value;
     return self;
 }
@@ -723,12 +1080,45 @@ DLLEXPORT size_t cos_real_write(CosReal* self, char* out, size_t out_len) {
 
 
 DLLEXPORT CosName* cos_name_new(PDF_TYPE_CODE_POINTS value, uint16_t value_len) {
-    CosName* self = malloc(sizeof(CosName));
-    self->type = COS_NODE_NAME;
-    self->check_sum = COS_CHECK_SUM(self);
-    self->ref_count = 1;
-    self->value = malloc(sizeof(PDF_TYPE_CODE_POINT) * value_len);
-    memcpy(self->value, value, sizeof(PDF_TYPE_CODE_POINT) * value_len);
+    return cos_name_new_in(NULL, value, value_len);
+}
+
+DLLEXPORT CosName* cos_name_intern(PDF_TYPE_CODE_POINTS value, uint16_t value_len) {
+    size_t low = 0, high = COS_NAME_INTERN_COUNT;
+
+    if (value_len == 0 || value_len > COS_NAME_INTERN_MAX_LEN) return NULL;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        int cmp = _cmp_name_value(value, value_len, &_intern_names[mid]);
+        if (cmp == 0) {
+            return &_intern_names[mid];
+        }
+        else if (cmp < 0) {
+            high = mid;
+        }
+        else {
+            low = mid + 1;
+        }
+    }
+    return NULL;
+}
+
+DLLEXPORT CosName* cos_name_new_in(CosArena* arena, PDF_TYPE_CODE_POINTS value, uint16_t value_len) {
+    CosName* self;
+
+    if (value && (self = cos_name_intern(value, value_len))) {
+        return self;
+    }
+
+    self = _node_new(arena, sizeof(CosName), COS_NODE_NAME);
+    self->value = _alloc(arena, sizeof(PDF_TYPE_CODE_POINT) * value_len);
+    if (value) {
+        memcpy(self->value, value, sizeof(PDF_TYPE_CODE_POINT) * value_len);
+    }
+    else {
+        memset(self->value, 0, sizeof(PDF_TYPE_CODE_POINT) * value_len);
+    }
     self->value_len = value_len;
     return self;
  }
@@ -737,42 +1127,69 @@ DLLEXPORT size_t cos_name_write(CosName* self, char* out, size_t out_len) {
     return  pdf_write_name(self->value, self->value_len, out, out_len);
 }
 
-DLLEXPORT CosLiteralStr* cos_literal_new(PDF_TYPE_STRING value, size_t value_len) {
-    CosLiteralStr* self = malloc(sizeof(CosLiteralStr));
-    self->type = COS_NODE_LIT_STR;
-    self->check_sum = COS_CHECK_SUM(self);
-    self->ref_count = 1;
-    self->value = malloc(sizeof(*value) * value_len);
-    memcpy(self->value, value, sizeof(*value) * value_len);
+static struct CosStringyNode* _stringy_new(CosArena* arena, CosNodeType type, PDF_TYPE_STRING value, size_t value_len, int borrow) {
+    struct CosStringyNode* self = _node_new(arena, sizeof(struct CosStringyNode), type);
+    if (borrow) {
+        self->value = value;
+        self->flags |= COS_NODE_FLAG_BORROWED;
+        /* may be materialized later, to the heap */
+        if (arena) _arena_finalize(arena, (CosNode*)self);
+    }
+    else {
+        self->value = _alloc(arena, sizeof(*value) * value_len);
+        memcpy(self->value, value, sizeof(*value) * value_len);
+    }
     self->value_len = value_len;
     return self;
- }
+}
+
+DLLEXPORT CosLiteralStr* cos_literal_new(PDF_TYPE_STRING value, size_t value_len) {
+    return cos_literal_new_in(NULL, value, value_len);
+}
+
+DLLEXPORT CosLiteralStr* cos_literal_new_in(CosArena* arena, PDF_TYPE_STRING value, size_t value_len) {
+    return _stringy_new(arena, COS_NODE_LIT_STR, value, value_len, 0);
+}
+
+DLLEXPORT CosLiteralStr* cos_literal_borrow(PDF_TYPE_STRING value, size_t value_len) {
+    return _stringy_new(NULL, COS_NODE_LIT_STR, value, value_len, 1);
+}
+
+DLLEXPORT CosLiteralStr* cos_literal_borrow_in(CosArena* arena, PDF_TYPE_STRING value, size_t value_len) {
+    return _stringy_new(arena, COS_NODE_LIT_STR, value, value_len, 1);
+}
 
 DLLEXPORT size_t cos_literal_write(CosLiteralStr* self, char* out, size_t out_len) {
     return  pdf_write_literal(self->value, self->value_len, out, out_len);
 }
 
 DLLEXPORT CosHexString* cos_hex_string_new(PDF_TYPE_STRING value, size_t value_len) {
-    CosHexString* self = malloc(sizeof(CosHexString));
-    self->type = COS_NODE_HEX_STR;
-    self->check_sum = COS_CHECK_SUM(self);
-    self->ref_count = 1;
-    self->value = malloc(sizeof(*value) * value_len);
-    memcpy(self->value, value, sizeof(*value) * value_len);
-    self->value_len = value_len;
-    return self;
- }
+    return cos_hex_string_new_in(NULL, value, value_len);
+}
+
+DLLEXPORT CosHexString* cos_hex_string_new_in(CosArena* arena, PDF_TYPE_STRING value, size_t value_len) {
+    return _stringy_new(arena, COS_NODE_HEX_STR, value, value_len, 0);
+}
+
+DLLEXPORT CosHexString* cos_hex_string_borrow(PDF_TYPE_STRING value, size_t value_len) {
+    return _stringy_new(NULL, COS_NODE_HEX_STR, value, value_len, 1);
+}
+
+DLLEXPORT CosHexString* cos_hex_string_borrow_in(CosArena* arena, PDF_TYPE_STRING value, size_t value_len) {
+    return _stringy_new(arena, COS_NODE_HEX_STR, value, value_len, 1);
+}
 
 DLLEXPORT size_t cos_hex_string_write(CosHexString* self, char* out, size_t out_len) {
     return pdf_write_hex_string(self->value, self->value_len, out, out_len);
 }
 
 DLLEXPORT CosComment* cos_comment_new(PDF_TYPE_STRING value, size_t value_len) {
-    CosComment* self = malloc(sizeof(CosComment));
-    self->type = COS_NODE_COMMENT;
-    self->check_sum = COS_CHECK_SUM(self);
-    self->ref_count = 1;
-    self->value = malloc(sizeof(*value) * value_len);
+    return cos_comment_new_in(NULL, value, value_len);
+}
+
+DLLEXPORT CosComment* cos_comment_new_in(CosArena* arena, PDF_TYPE_STRING value, size_t value_len) {
+    CosComment* self = _node_new(arena, sizeof(CosComment), COS_NODE_COMMENT);
+    self->value = _alloc(arena, sizeof(*value) * value_len);
     memcpy(self->value, value, sizeof(*value) * value_len);
     self->value_len = value_len;
     return self;
@@ -788,11 +1205,11 @@ DLLEXPORT size_t cos_comment_write(CosComment* self, char* out, size_t out_len,
 }
 
 DLLEXPORT CosNull* cos_null_new(void) {
-    CosNull* self = malloc(sizeof(CosNull));
-    self->type = COS_NODE_NULL;
-    self->check_sum = COS_CHECK_SUM(self);
-    self->ref_count = 1;
-    return self;
+    return cos_null_new_in(NULL);
+}
+
+DLLEXPORT CosNull* cos_null_new_in(CosArena* arena) {
+    return _node_new(arena, sizeof(CosNull), COS_NODE_NULL);
 }
 
 DLLEXPORT size_t cos_null_write(CosNull* _self, char* out, size_t out_len) {
@@ -951,21 +1368,22 @@ static CosOpCode _lookup_op_code(char *opn) {
 }
 
 DLLEXPORT CosOp* cos_op_new(char* opn, int opn_len, CosNode** values, size_t elems) {
+    return cos_op_new_in(NULL, opn, opn_len, values, elems);
+}
+
+DLLEXPORT CosOp* cos_op_new_in(CosArena* arena, char* opn, int opn_len, CosNode** values, size_t elems) {
     size_t i;
-    CosOp* self = malloc(sizeof(CosOp));
-    self->type = COS_NODE_OP;
-    self->check_sum = COS_CHECK_SUM(self);
-    self->ref_count = 1;
-    self->opn = malloc(opn_len + 1);
+    CosOp* self = _node_new(arena, sizeof(CosOp), COS_NODE_OP);
+    self->opn = _alloc(arena, opn_len + 1);
     strncpy(self->opn, opn, opn_len);
     self->opn[opn_len] = 0;
     self->sub_type = _lookup_op_code(self->opn);
     self->elems = elems;
-    self->values = malloc(sizeof(CosNode*) * elems);
+    self->values = _alloc(arena, sizeof(CosNode*) * elems);
     if (values) {
         for (i=0; i < elems; i++) {
             self->values[i] = values[i];
-            cos_node_reference(values[i]);
+            _member_reference(arena, values[i]);
         }
     }
     else {
@@ -1145,17 +1563,18 @@ DLLEXPORT size_t cos_op_write(CosOp* self, char* out, size_t out_len, int indent
 }
 
 DLLEXPORT CosContent* cos_content_new(CosOp** values, size_t elems) {
+    return cos_content_new_in(NULL, values, elems);
+}
+
+DLLEXPORT CosContent* cos_content_new_in(CosArena* arena, CosOp** values, size_t elems) {
     size_t i;
-    CosContent* self = malloc(sizeof(CosContent));
-    self->type = COS_NODE_CONTENT;
-    self->check_sum = COS_CHECK_SUM(self);
-    self->ref_count = 1;
+    CosContent* self = _node_new(arena, sizeof(CosContent), COS_NODE_CONTENT);
     self->elems = elems;
-    self->values = malloc(sizeof(CosOp*) * elems);
+    self->values = _alloc(arena, sizeof(CosOp*) * elems);
     if (values) {
         for (i=0; i < elems; i++) {
             self->values[i] = values[i];
-            cos_node_reference((CosNode*)values[i]);
+            _member_reference(arena, (CosNode*)values[i]);
         }
     }
     else {
@@ -1209,13 +1628,29 @@ DLLEXPORT size_t cos_content_write(CosContent* self, char* out, size_t out_len)
     return n;
 }
 
-DLLEXPORT CosInlineImage* cos_inline_image_new(CosDict* dict, unsigned char* value, size_t value_len) {
-    CosInlineImage* self = (void*) cos_stream_new(dict, value, value_len);
+static CosInlineImage* _inline_image_new(CosArena* arena, CosDict* dict, unsigned char* value, size_t value_len, int borrow) {
+    CosInlineImage* self = (void*) _stream_new(arena, dict, value, value_len, borrow);
     self->type = COS_NODE_INLINE_IMAGE;
     self->check_sum = COS_CHECK_SUM(self);
     return self;
 }
 
+DLLEXPORT CosInlineImage* cos_inline_image_new(CosDict* dict, unsigned char* value, size_t value_len) {
+    return cos_inline_image_new_in(NULL, dict, value, value_len);
+}
+
+DLLEXPORT CosInlineImage* cos_inline_image_new_in(CosArena* arena, CosDict* dict, unsigned char* value, size_t value_len) {
+    return _inline_image_new(arena, dict, value, value_len, 0);
+}
+
+DLLEXPORT CosInlineImage* cos_inline_image_borrow(CosDict* dict, unsigned char* value, size_t value_len) {
+    return _inline_image_new(NULL, dict, value, value_len, 1);
+}
+
+DLLEXPORT CosInlineImage* cos_inline_image_borrow_in(CosArena* arena, CosDict* dict, unsigned char* value, size_t value_len) {
+    return _inline_image_new(arena, dict, value, value_len, 1);
+}
+
 DLLEXPORT size_t cos_inline_image_write(CosInlineImage* self, char* out, size_t out_len, int indent) {
     size_t n = 0, m, i;
     CosDict* dict = self->dict;
@@ -1252,7 +1687,7 @@ DLLEXPORT size_t cos_node_get_write_size(CosNode* self, int indent) {
     case COS_NODE_IND_OBJ:
         return 50 + cos_node_get_write_size(((CosIndObj*)self)->value, 0);
     case COS_NODE_INT:
-        return snprintf(out, sizeof(out), "%" PRId64, ((CosInt*)self)->value);
+        return cos_int_write((CosInt*)self, out, sizeof(out));
     case COS_NODE_BOOL:
         return 5;
     case COS_NODE_NULL:
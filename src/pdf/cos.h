@@ -64,16 +64,23 @@ typedef enum {
     COS_OP_MoveShowText
 } CosOpCode;
 
+/* node flags */
+#define COS_NODE_FLAG_ARENA 1 /* allocated from a CosArena, not ref-counted */
+#define COS_NODE_FLAG_BORROWED 2 /* value references a caller's buffer */
+#define COS_NODE_FLAG_INTERNED 4 /* shared common name, not ref-counted */
+
 typedef struct {
     uint8_t         type;
     uint8_t         check_sum;
-    uint16_t        ref_count;
+    uint8_t         flags;
+    uint32_t        ref_count;
 } CosNode, CosNull;
 
 typedef struct {
     uint8_t         type;
     uint8_t         check_sum;
-    uint16_t        ref_count;
+    uint8_t         flags;
+    uint32_t        ref_count;
     uint64_t        obj_num;
     uint32_t        gen_num;
 } CosRef;
@@ -81,7 +88,8 @@ typedef struct {
 typedef struct {
     uint8_t         type;
     uint8_t         check_sum;
-    uint16_t        ref_count;
+    uint8_t         flags;
+    uint32_t        ref_count;
     uint64_t        obj_num;
     uint32_t        gen_num;
     CosNode*        value;
@@ -90,7 +98,8 @@ typedef struct {
 typedef struct {
     uint8_t         type;
     uint8_t         check_sum;
-    uint16_t        ref_count;
+    uint8_t         flags;
+    uint32_t        ref_count;
     PDF_TYPE_CODE_POINTS value;
     uint16_t        value_len;
 } CosName;
@@ -98,7 +107,8 @@ typedef struct {
 typedef struct CosContainerNode {
     uint8_t         type;
     uint8_t         check_sum;
-    uint16_t        ref_count;
+    uint8_t         flags;
+    uint32_t        ref_count;
     size_t          elems;
     CosNode**       values;
 } CosArray;
@@ -106,40 +116,50 @@ typedef struct CosContainerNode {
 typedef struct {
     uint8_t         type;
     uint8_t         check_sum;
-    uint16_t        ref_count;
+    uint8_t         flags;
+    uint32_t        ref_count;
     size_t          elems;
     CosNode**       values;
     /* struct CosContainerNode */
     CosName**       keys;
     size_t*         index;
     size_t          index_len;
+    size_t*         hash;
+    size_t          hash_size;
 } CosDict;
 
+/* dictionaries with fewer entries are searched linearly, rather than hashed */
+#define COS_DICT_HASH_MIN 16
+
 typedef struct {
     uint8_t         type;
     uint8_t         check_sum;
-    uint16_t        ref_count;
+    uint8_t         flags;
+    uint32_t        ref_count;
     PDF_TYPE_BOOL   value;
 } CosBool;
 
 typedef struct {
     uint8_t         type;
     uint8_t         check_sum;
-    uint16_t        ref_count;
+    uint8_t         flags;
+    uint32_t        ref_count;
     PDF_TYPE_INT64  value;
 } CosInt;
 
 typedef struct {
     uint8_t         type;
     uint8_t         check_sum;
-    uint16_t        ref_count;
+    uint8_t         flags;
+    uint32_t        ref_count;
     PDF_TYPE_REAL   value;
 } CosReal;
 
 typedef struct CosStringyNode {
     uint8_t         type;
     uint8_t         check_sum;
-    uint16_t        ref_count;
+    uint8_t         flags;
+    uint32_t        ref_count;
     PDF_TYPE_STRING value;
     size_t          value_len;
 } CosHexString, CosLiteralStr, CosComment;
@@ -147,7 +167,8 @@ typedef struct CosStringyNode {
 typedef struct CosStreamish {
     uint8_t         type;
     uint8_t         check_sum;
-    uint16_t        ref_count;
+    uint8_t         flags;
+    uint32_t        ref_count;
     CosDict*        dict;
     char*           value;
     union {
@@ -159,7 +180,8 @@ typedef struct CosStreamish {
 typedef struct {
     uint8_t         type;
     uint8_t         check_sum;
-    uint16_t        ref_count;
+    uint8_t         flags;
+    uint32_t        ref_count;
     size_t          elems;
     CosNode**       values;
     /* struct CosContainerNode */
@@ -170,21 +192,40 @@ typedef struct {
 typedef struct {
     uint8_t         type;
     uint8_t         check_sum;
-    uint16_t        ref_count;
+    uint8_t         flags;
+    uint32_t        ref_count;
     size_t          elems;
     CosOp**         values;
     /* struct CosContainerNode */
 } CosContent;
 
+/* Region allocator. Nodes created with the cos_*_new_in() constructors
+ * are allocated from the arena and released all at once by cos_arena_done().
+ * Arena nodes ignore cos_node_reference() and cos_node_done(), and don't
+ * hold references on their members; a heap member must outlive the arena. */
+typedef struct _CosArena CosArena;
+
+DLLEXPORT CosArena* cos_arena_new(size_t);
+DLLEXPORT void* cos_arena_alloc(CosArena*, size_t);
+DLLEXPORT void cos_arena_done(CosArena*);
+
+/* Borrowed payloads. The cos_*_borrow() constructors and
+ * cos_stream_borrow_data() reference the caller's buffer, rather than
+ * copying it. The buffer must outlive the node, or until
+ * cos_node_materialize() has been called on it, or an enclosing node. */
+DLLEXPORT void cos_node_materialize(CosNode*);
+
 DLLEXPORT void cos_node_reference(CosNode*);
 DLLEXPORT void cos_node_done(CosNode*);
 
 DLLEXPORT int cos_node_cmp(CosNode*, CosNode*);
 
 DLLEXPORT CosRef* cos_ref_new(uint64_t, uint32_t);
+DLLEXPORT CosRef* cos_ref_new_in(CosArena*, uint64_t, uint32_t);
 DLLEXPORT size_t cos_ref_write(CosRef*, char*, size_t);
 
 DLLEXPORT CosIndObj* cos_ind_obj_new(uint64_t, uint32_t, CosNode*);
+DLLEXPORT CosIndObj* cos_ind_obj_new_in(CosArena*, uint64_t, uint32_t, CosNode*);
 DLLEXPORT size_t cos_ind_obj_write(CosIndObj*, char*, size_t);
 
 typedef enum {
@@ -219,49 +260,77 @@ DLLEXPORT void cos_crypt_ctx_done(CosCryptNodeCtx*);
 DLLEXPORT void cos_ind_obj_crypt(CosIndObj*, CosCryptNodeCtx*);
 
 DLLEXPORT CosInt* cos_int_new(PDF_TYPE_INT);
+DLLEXPORT CosInt* cos_int_new_in(CosArena*, PDF_TYPE_INT);
 DLLEXPORT size_t cos_int_write(CosInt*, char*, size_t);
 
 DLLEXPORT CosBool* cos_bool_new(PDF_TYPE_BOOL value);
+DLLEXPORT CosBool* cos_bool_new_in(CosArena*, PDF_TYPE_BOOL value);
 DLLEXPORT size_t cos_bool_write(CosBool* self, char* out, size_t out_len);
 
 DLLEXPORT CosReal* cos_real_new(PDF_TYPE_REAL value);
+DLLEXPORT CosReal* cos_real_new_in(CosArena*, PDF_TYPE_REAL value);
 DLLEXPORT size_t cos_real_write(CosReal* self, char* out, size_t out_len);
 
 DLLEXPORT CosArray* cos_array_new(CosNode**, size_t);
+DLLEXPORT CosArray* cos_array_new_in(CosArena*, CosNode**, size_t);
 DLLEXPORT size_t cos_array_write(CosArray*, char*, size_t, int);
 
 DLLEXPORT CosDict* cos_dict_new(CosName**, CosNode**, size_t);
+DLLEXPORT CosDict* cos_dict_new_in(CosArena*, CosName**, CosNode**, size_t);
 DLLEXPORT size_t* cos_dict_build_index(CosDict*);
 DLLEXPORT CosNode* cos_dict_lookup(CosDict*, CosName*);
 DLLEXPORT size_t cos_dict_write(CosDict*, char*, size_t, int);
 
+/* Common names, such as /Type or /Length, are returned as shared,
+ * read-only instances. Dictionary lookups compare these by address. */
 DLLEXPORT CosName* cos_name_new(PDF_TYPE_CODE_POINTS, uint16_t);
+DLLEXPORT CosName* cos_name_new_in(CosArena*, PDF_TYPE_CODE_POINTS, uint16_t);
+/* the shared instance of a common name, or NULL */
+#define COS_NAME_INTERN_MAX_LEN 32
+DLLEXPORT CosName* cos_name_intern(PDF_TYPE_CODE_POINTS, uint16_t);
 DLLEXPORT size_t cos_name_write(CosName*, char*, size_t);
 
 DLLEXPORT CosLiteralStr* cos_literal_new(PDF_TYPE_STRING, size_t);
+DLLEXPORT CosLiteralStr* cos_literal_new_in(CosArena*, PDF_TYPE_STRING, size_t);
+DLLEXPORT CosLiteralStr* cos_literal_borrow(PDF_TYPE_STRING, size_t);
+DLLEXPORT CosLiteralStr* cos_literal_borrow_in(CosArena*, PDF_TYPE_STRING, size_t);
 DLLEXPORT size_t cos_literal_write(CosLiteralStr*, char*, size_t);
 
 DLLEXPORT CosHexString* cos_hex_string_new(PDF_TYPE_STRING, size_t);
+DLLEXPORT CosHexString* cos_hex_string_new_in(CosArena*, PDF_TYPE_STRING, size_t);
+DLLEXPORT CosHexString* cos_hex_string_borrow(PDF_TYPE_STRING, size_t);
+DLLEXPORT CosHexString* cos_hex_string_borrow_in(CosArena*, PDF_TYPE_STRING, size_t);
 DLLEXPORT size_t cos_hex_string_write(CosHexString*, char*, size_t);
 
 DLLEXPORT CosNull* cos_null_new(void);
+DLLEXPORT CosNull* cos_null_new_in(CosArena*);
 DLLEXPORT size_t cos_null_write(CosNull*, char*, size_t);
 
 DLLEXPORT CosStream* cos_stream_new(CosDict*, unsigned char*, size_t);
+DLLEXPORT CosStream* cos_stream_new_in(CosArena*, CosDict*, unsigned char*, size_t);
+DLLEXPORT CosStream* cos_stream_borrow(CosDict*, unsigned char*, size_t);
+DLLEXPORT CosStream* cos_stream_borrow_in(CosArena*, CosDict*, unsigned char*, size_t);
 DLLEXPORT int cos_stream_attach_data(CosStream*, unsigned char* , size_t, size_t);
+DLLEXPORT int cos_stream_borrow_data(CosStream*, unsigned char* , size_t, size_t);
 DLLEXPORT size_t cos_stream_write(CosStream*, char*, size_t);
 
 DLLEXPORT CosOp* cos_op_new(char*, int, CosNode**, size_t);
+DLLEXPORT CosOp* cos_op_new_in(CosArena*, char*, int, CosNode**, size_t);
 DLLEXPORT int cos_op_is_valid(CosOp*);
 DLLEXPORT size_t cos_op_write(CosOp*, char*, size_t, int);
 
 DLLEXPORT CosContent* cos_content_new(CosOp**, size_t);
+DLLEXPORT CosContent* cos_content_new_in(CosArena*, CosOp**, size_t);
 DLLEXPORT size_t cos_content_write(CosContent*, char*, size_t);
 
 DLLEXPORT CosInlineImage* cos_inline_image_new(CosDict* dict, unsigned char* value, size_t value_len);
+DLLEXPORT CosInlineImage* cos_inline_image_new_in(CosArena*, CosDict* dict, unsigned char* value, size_t value_len);
+DLLEXPORT CosInlineImage* cos_inline_image_borrow(CosDict* dict, unsigned char* value, size_t value_len);
+DLLEXPORT CosInlineImage* cos_inline_image_borrow_in(CosArena*, CosDict* dict, unsigned char* value, size_t value_len);
 DLLEXPORT size_t cos_inline_image_write(CosInlineImage*, char*, size_t, int);
 
 DLLEXPORT CosComment* cos_comment_new(PDF_TYPE_STRING, size_t);
+DLLEXPORT CosComment* cos_comment_new_in(CosArena*, PDF_TYPE_STRING, size_t);
 DLLEXPORT size_t cos_comment_write(CosComment*, char*, size_t, int);
 
 DLLEXPORT size_t cos_node_get_write_size(CosNode*, int);
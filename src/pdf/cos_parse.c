@@ -20,18 +20,37 @@
  *   - parse a content stream, as a series of CosOp* objects, sprinkled
  *     with occasional chunkier CosInlineImage* objects
  *
+ * There's also a recovery scanner for damaged files:
+ *
+ * size_t cos_parse_repair(PDF_TYPE_XREF, size_t, char*, size_t)
+ *   - scan a whole PDF for indirect objects, rebuilding the cross
+ *     reference index, in the same layout as pdf_read_xref()
+ *
+ * PDF_TYPE_XREF cos_parse_repair_alloc(char*, size_t, size_t*)
+ *   - as above, in a single pass, returning all of the entries, to be
+ *     freed by cos_parse_repair_free()
+ *
+ * Each has a cos_parse_*_in() variant that takes a CosArena*. Nodes are
+ * then allocated from the arena, and are released together by
+ * cos_arena_done().
+ *
+ * cos_parse_ind_obj() also accepts the COS_PARSE_BORROW flag. Stream data
+ * and literal strings without escapes then reference the input buffer,
+ * which must be kept, or the object materialized; see cos_node_materialize().
+ *
  */
 
 #include "pdf.h"
 #include "pdf/cos.h"
 #include "pdf/cos_parse.h"
 #include "pdf/utf8.h"
+#include "pdf/scan.h"
 #include <stdio.h>
-#include <ctype.h>
 #include <assert.h>
 #include <string.h>
 #include <stdlib.h>
 #include <inttypes.h>
+#include <locale.h>
 
 typedef enum {
     COS_TK_START,
@@ -55,22 +74,38 @@ typedef struct {
     size_t buf_pos;
     CosTk* tk[3]; /* small look-ahead buffer */
     uint8_t n_tk;
+    CosArena* arena; /* optional, for node allocation */
+    uint8_t borrow;  /* reference, rather than copy, the input buffer */
 } CosParserCtx;
 
-static CosNode** _parse_objects(CosParserCtx*, size_t*, char*);
+/* growable vector of parsed nodes */
+typedef struct {
+    CosNode** values;
+    size_t elems;
+    size_t size;
+} CosNodeVec;
+
+/* an open array or dictionary; its members are on the node vector,
+   from 'start' onwards */
+typedef struct {
+    size_t start;
+    char ch; /* '[' or '<' */
+} CosParseFrame;
 
 static size_t _skip_ws(CosParserCtx* ctx) {
-    int in_comment = 0;
 
-    for (; ctx->buf_pos < ctx->buf_len; ctx->buf_pos++) {
-        unsigned char ch = ctx->buf[ctx->buf_pos];
-        if (in_comment) {
-            if (ch == '\n' || ch == '\r') in_comment = 0;
+    while (ctx->buf_pos < ctx->buf_len) {
+        char* pos = ctx->buf + ctx->buf_pos;
+        size_t len = ctx->buf_len - ctx->buf_pos;
+
+        if (*pos == '%') {
+            /* comment, up to the end of the line */
+            ctx->buf_pos += 1 + pdf_scan_eol(pos + 1, len - 1);
         }
-        else if (ch == '%') {
-            in_comment = 1;
+        else if (PDF_CC(*pos, PDF_CC_SPACE|PDF_CC_NUL)) {
+            ctx->buf_pos += pdf_scan_space(pos, len);
         }
-        else if (ch && !isspace(ch)) {
+        else {
             break;
         }
     }
@@ -110,9 +145,20 @@ static CosTk* _scan_tk(CosParserCtx* ctx) {
     tk->len  = 0;
 
     for (; ctx->buf_pos <= ctx->buf_len && !wb; ctx->buf_pos++) {
+        unsigned char ch;
+
+        if ((tk->type == COS_TK_NAME || tk->type == COS_TK_WORD) && ctx->buf_pos < ctx->buf_len) {
+            /* fast-forward over regular characters; these don't change the token type */
+            size_t n = pdf_scan_regular(ctx->buf + ctx->buf_pos, ctx->buf_len - ctx->buf_pos);
+            if (n) {
+                ctx->buf_pos += n;
+                tk->len += n;
+                prev_ch = ctx->buf[ctx->buf_pos - 1];
+            }
+        }
 
         if (ctx->buf_pos >= ctx->buf_len) { wb = 1; continue; }
-        unsigned char ch = ctx->buf[ctx->buf_pos];
+        ch = ctx->buf[ctx->buf_pos];
 
         if (ch >= '0' && ch <= '9') {
             got_digits = 1;
@@ -196,7 +242,7 @@ static CosTk* _scan_tk(CosParserCtx* ctx) {
             }
             break;
         default:
-            if (!ch || ch == '%' || isspace(ch)) {
+            if (ch == '%' || PDF_CC(ch, PDF_CC_SPACE|PDF_CC_NUL)) {
                 /* whitespace or starting comment */
                 wb = 1;
             }
@@ -311,71 +357,89 @@ static int _hex_value(char ch) {
     return -1;
 }
 
+/* next byte of a name, decoding '#xx' escapes; -1 on a bad escape */
+static int _name_byte(unsigned char** pos, unsigned char* end) {
+    int ch = *(*pos)++;
+
+    if (ch == '#') {
+        int d1, d2;
+        if (*pos < end && **pos == '#') {
+            /* escaped '#' */
+            return *(*pos)++;
+        }
+        if (*pos + 1 >= end) return -1;
+        d1 = _hex_value((*pos)[0]);
+        d2 = _hex_value((*pos)[1]);
+        if (d1 < 0 || d2 < 0) return -1;
+        *pos += 2;
+        ch = d1 * 16  +  d2;
+    }
+
+    return ch;
+}
+
 static CosName* _parse_name(CosParserCtx* ctx) {
     CosTk* tk = _look_ahead(ctx, 1);
     CosName* name = NULL;
 
-    if (tk->type == COS_TK_NAME) {
-        uint8_t* bytes = malloc(tk->len + 5);
-        char* pos = ctx->buf + tk->pos + 1; /* consume '/' */
-        char* end = pos + tk->len - 1;
-        size_t n_bytes;
-        PDF_TYPE_CODE_POINTS codes = NULL;
-        size_t n_codes;
-        size_t i = 0;
-
-        /* 1st pass: collect bytes */
-        for (n_bytes = 0; pos < end; pos++) {
-            unsigned char ch = *pos;
-
-            if (ch == '#') {
-                /* escape sequence */
-                if (pos+1 >= end) goto bail;
-                if (*(pos+1) == '#') {
-                    /* escaped '#' */
-                    bytes[n_bytes++] = *(++pos);
-                }
-                else if (pos + 1 > end) {
-                    goto bail;
-                }
-                else {
-                    /* hex encoded byte */
-                    int d1 = _hex_value(*(++pos));
-                    int d2 = _hex_value(*(++pos));
-                    if (d1 < 0 || d2 < 0) goto bail;
+    if (tk->type == COS_TK_NAME && tk->len <= UINT16_MAX) {
+        unsigned char* pos = (unsigned char*) ctx->buf + tk->pos + 1; /* consume '/' */
+        unsigned char* end = pos + tk->len - 1;
+        size_t len = end - pos;
+        size_t n_codes = 0;
+        size_t i;
 
-                    bytes[n_bytes++] = d1 * 16  +  d2;
-                }
-            }
-            else {
-                bytes[n_bytes++] = ch;
-            }
+        /* fast path: plain ASCII, without escapes */
+        for (i = 0; i < len && pos[i] < 0x80 && pos[i] != '#'; i++) {
+        }
+
+        if (i == len && len <= COS_NAME_INTERN_MAX_LEN) {
+            /* short; possibly a common name */
+            PDF_TYPE_CODE_POINT value[COS_NAME_INTERN_MAX_LEN];
+            for (i = 0; i < len; i++) value[i] = pos[i];
+            return cos_name_new_in(ctx->arena, value, len);
         }
 
-        /* 2nd pass: count codes */
-        for (n_codes = 0, i = 0; i < n_bytes; n_codes++) {
-            int char_len = utf8_char_len(bytes[i]);
-            if (char_len <= 0) char_len = 1;
-            i += char_len;
+        /* there are at most as many codes as bytes */
+        name = cos_name_new_in(ctx->arena, NULL, len);
+        for (n_codes = 0; n_codes < i; n_codes++) {
+            name->value[n_codes] = pos[n_codes];
         }
+        pos += i;
 
-        codes = malloc(n_codes * sizeof(PDF_TYPE_CODE_POINT));
+        /* general path: escapes and UTF-8 sequences */
+        while (pos < end) {
+            uint8_t bytes[4];
+            int byte = _name_byte(&pos, end);
+            int char_len, k;
 
-        /* 3rd pass: assesemble codes */
-        for (n_codes = 0, i = 0; i < n_bytes; n_codes++) {
-            int char_len = utf8_char_len(bytes[i]);
-            if (char_len <= 0) char_len = 1;
-            codes[n_codes] = utf8_to_code(bytes + i);
-            i += char_len;
+            if (byte < 0) goto bail;
+            bytes[0] = byte;
+            char_len = utf8_char_len(byte);
+
+            for (k = 1; k < char_len && pos < end; k++) {
+                if ((byte = _name_byte(&pos, end)) < 0) goto bail;
+                bytes[k] = byte;
+            }
+
+            if (char_len > 1 && k == char_len) {
+                name->value[n_codes++] = utf8_to_code(bytes);
+            }
+            else {
+                /* malformed or truncated; keep the bytes as they are */
+                int j;
+                for (j = 0; j < k; j++) name->value[n_codes++] = bytes[j];
+            }
         }
 
-        name = cos_name_new(codes, n_codes);
-    bail:
-        free(bytes);
-        if (codes) free(codes);
+        name->value_len = n_codes;
     }
 
     return name;
+
+bail:
+    cos_node_done((CosNode*)name);
+    return NULL;
 }
 
 static char* _strnchr(char* buf, char c, size_t n) {
@@ -386,15 +450,53 @@ static char* _strnchr(char* buf, char c, size_t n) {
     return NULL;
 }
 
+/* powers of ten that are exactly representable as doubles */
+static const PDF_TYPE_REAL _exact_pow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#define COS_REAL_MAX_EXACT_EXP 22
+#define COS_REAL_MAX_EXACT_MANTISSA ((uint64_t)1 << 53)
+#define COS_REAL_MAX_DIGITS 19
+
+/* slow path: unsigned decimal, of the form digits.digits */
+static PDF_TYPE_REAL _strtod(char* p, size_t len) {
+    /* strtod() expects the locale's decimal point */
+    const char* lc_dp = localeconv()->decimal_point;
+    size_t lc_dp_len = strlen(lc_dp);
+    char small[64];
+    char* s = len + lc_dp_len < sizeof(small) ? small : malloc(len + lc_dp_len);
+    PDF_TYPE_REAL val;
+    size_t i, n = 0;
+
+    for (i = 0; i < len; i++) {
+        if (p[i] == '.') {
+            memcpy(s + n, lc_dp, lc_dp_len);
+            n += lc_dp_len;
+        }
+        else {
+            s[n++] = p[i];
+        }
+    }
+    s[n] = 0;
+
+    val = strtod(s, NULL);
+    if (s != small) free(s);
+    return val;
+}
+
 static PDF_TYPE_REAL _read_real(CosParserCtx* ctx, CosTk* tk) {
-    PDF_TYPE_REAL val = 0.0;
-    PDF_TYPE_REAL frac = 0.0;
-    PDF_TYPE_REAL magn = 1.0;
     char* buf = ctx->buf + tk->pos;
     char* end = buf + tk->len;
-    char* dp  = _strnchr(buf, '.', tk->len);
+    char* dp;
     char* p;
+    uint64_t mantissa = 0;
+    int n_digits = 0;
+    int exp10 = 0;
+    int in_frac = 0;
     int sign = 1;
+    PDF_TYPE_REAL val;
 
     assert(tk->type == COS_TK_REAL);
 
@@ -408,22 +510,45 @@ static PDF_TYPE_REAL _read_real(CosParserCtx* ctx, CosTk* tk) {
         break;
     }
 
-    if (!dp) dp = end;
-
-    while (*end == '0' && end > dp) end--;
+    dp = _strnchr(buf, '.', end - buf);
+    if (dp) {
+        while (end > dp + 1 && end[-1] == '0') end--;
+    }
 
-    for (p = buf; p < dp; p++) {
-        val *= 10;
-        val += (*p - '0');
+    /* accumulate up to 19 significant digits; the decimal exponent
+       counts fractional digits */
+    for (p = buf; p < end; p++) {
+        if (*p == '.') {
+            in_frac = 1;
+        }
+        else if (mantissa == 0 && *p == '0') {
+            /* leading zero */
+            if (in_frac) exp10--;
+        }
+        else if (n_digits < COS_REAL_MAX_DIGITS) {
+            mantissa = mantissa * 10 + (*p - '0');
+            n_digits++;
+            if (in_frac) exp10--;
+        }
+        else {
+            /* too many digits to convert exactly */
+            break;
+        }
     }
 
-    for (p = dp + 1; p < end; p++) {
-        magn *= 10;
-        frac *= 10;
-        frac += (*p - '0');
+    if (p == end
+        && mantissa <= COS_REAL_MAX_EXACT_MANTISSA
+        && exp10 >= -COS_REAL_MAX_EXACT_EXP) {
+        /* mantissa and scale are exact, so a single multiply or divide
+           is correctly rounded (Clinger's fast path) */
+        val = exp10 < 0
+            ? (PDF_TYPE_REAL) mantissa / _exact_pow10[-exp10]
+            : (PDF_TYPE_REAL) mantissa;
+    }
+    else {
+        val = _strtod(buf, end - buf);
     }
 
-    val += frac / magn;
     return sign > 0 ? val : -val;
 }
 
@@ -432,7 +557,7 @@ static int _at_token(CosParserCtx* ctx, CosTk* tk, char* word) {
 }
 
 static int _at_uint(CosParserCtx* ctx, CosTk* tk) {
-    return tk->type == COS_TK_INT && isdigit(ctx->buf[tk->pos]);
+    return tk->type == COS_TK_INT && PDF_CC(ctx->buf[tk->pos], PDF_CC_DIGIT);
 }
 
 static int _at_op(CosParserCtx* ctx, CosTk* tk) {
@@ -441,7 +566,7 @@ static int _at_op(CosParserCtx* ctx, CosTk* tk) {
 
         for (i = 0; i < tk->len; i++) {
             unsigned char ch = ctx->buf[tk->pos + i];
-            if (!isgraph(ch)) return 0;
+            if (!PDF_CC(ch, PDF_CC_GRAPH)) return 0;
         }
         return 1;
     }
@@ -456,14 +581,26 @@ static int _shift_word(CosParserCtx* ctx, char* word) {
     return found;
 }
 
-static void _done_objects(CosNode** objects, size_t n) {
-    if (objects) {
-        size_t i;
-        for (i = 0; i < n; i++) {
-            if (objects[i]) cos_node_done(objects[i]);
-        }
-        free(objects);
+static void _vec_push(CosNodeVec* vec, CosNode* node) {
+    if (vec->elems >= vec->size) {
+        vec->size = vec->size ? vec->size * 2 : 16;
+        vec->values = realloc(vec->values, vec->size * sizeof(CosNode*));
+    }
+    vec->values[vec->elems++] = node;
+}
+
+/* release nodes from position 'start' onwards */
+static void _vec_truncate(CosNodeVec* vec, size_t start) {
+    size_t i;
+    for (i = start; i < vec->elems; i++) {
+        cos_node_done(vec->values[i]);
     }
+    vec->elems = start;
+}
+
+static void _vec_done(CosNodeVec* vec) {
+    _vec_truncate(vec, 0);
+    if (vec->values) free(vec->values);
 }
 
 static int _octal_nibble(char **pos, char *end, int val, int n) {
@@ -481,10 +618,12 @@ static int _octal_nibble(char **pos, char *end, int val, int n) {
 }
 
 static int _lit_str_nibble(char **pos, char *end, int *nesting) {
-    unsigned char ch = *(++(*pos));
+    unsigned char ch;
+    if (*pos + 1 >= end) return -1; /* unterminated */
+    ch = *(++(*pos));
     switch (ch) {
     case '\\':
-        if (*pos >= end) return -1;
+        if (*pos + 1 >= end) return -1;
         ch = *(++(*pos));
         if (ch >= '0' && ch <= '7') {
             return _octal_nibble(pos, end, 0, 1);
@@ -496,7 +635,7 @@ static int _lit_str_nibble(char **pos, char *end, int *nesting) {
             case 'b': return '\b';
             case 'f': return '\f';
             case '\r':
-                if (*pos < end && *(*pos+1) == '\n') ++(*pos);
+                if (*pos + 1 < end && *(*pos+1) == '\n') ++(*pos);
                 /* fallthrough */
             case '\n':
                 return _lit_str_nibble(pos, end, nesting);
@@ -524,7 +663,11 @@ static CosLiteralStr* _parse_lit_string(CosParserCtx* ctx) {
         n_bytes++;
     };
 
-    if (nesting == 0) {
+    if (nesting == 0 && ctx->borrow && n_bytes == (size_t)(lit_end - lit_pos - 1)) {
+        /* no escape sequences; the string is verbatim */
+        lit_string = cos_literal_borrow_in(ctx->arena, (PDF_TYPE_STRING) lit_pos + 1, n_bytes);
+    }
+    else if (nesting == 0) {
         /* found a properly terminated string; process it */
         PDF_TYPE_STRING bytes = malloc(n_bytes);
         int byte;
@@ -535,7 +678,7 @@ static CosLiteralStr* _parse_lit_string(CosParserCtx* ctx) {
             bytes[n_bytes++] = byte;
         }
 
-        lit_string = cos_literal_new(bytes, n_bytes);
+        lit_string = cos_literal_new_in(ctx->arena, bytes, n_bytes);
 
         free(bytes);
     }
@@ -547,7 +690,7 @@ static CosLiteralStr* _parse_lit_string(CosParserCtx* ctx) {
 
 static void _scan_ws(char** pos, char* end) {
 
-    while (isspace(**pos) && *pos < end) {
+    while (*pos < end && PDF_CC(**pos, PDF_CC_SPACE)) {
         (*pos)++;
     }
 }
@@ -572,7 +715,7 @@ static CosHexString* _parse_hex_string(CosParserCtx* ctx) {
             if (d1 < 0 || d2 < 0) goto bail;
             hex_bytes[n++] = d1 * 16  +  d2;
         }
-        hex_string = cos_hex_string_new(hex_bytes, n);
+        hex_string = cos_hex_string_new_in(ctx->arena, hex_bytes, n);
     bail:
         free(hex_bytes);
         _resume_parse(ctx, hex_end + 1);
@@ -581,52 +724,38 @@ static CosHexString* _parse_hex_string(CosParserCtx* ctx) {
     return hex_string;
 }
 
-static CosArray* _parse_array(CosParserCtx* ctx) {
-    size_t n = 0;
-    CosNode** objects = _parse_objects(ctx, &n, "]");
-    CosArray* array = NULL;
-    if (n == 0 || objects[n-1] != NULL) {
-        array = cos_array_new(objects, n);
-    }
-    _done_objects(objects, n);
+/* build an array; takes over references to the objects */
+static CosArray* _objects_to_array(CosParserCtx* ctx, CosNode** objects, size_t n) {
+    CosArray* array = cos_array_new_in(ctx->arena, NULL, n);
+    if (n) memcpy(array->values, objects, n * sizeof(CosNode*));
     return array;
 }
 
-static CosDict* _pairs_to_dict(CosNode** objects, size_t n) {
+/* build a dictionary from key/value pairs; takes over references
+   to the objects on success */
+static CosDict* _pairs_to_dict(CosParserCtx* ctx, CosNode** objects, size_t n) {
     size_t elems = n / 2;
-    CosDict* dict = NULL;
-    CosName** keys = NULL;
-    CosNode** values = NULL;
+    CosDict* dict;
     size_t i;
 
-    if (n % 2) goto bail;
-    if (n && (!objects || objects[n-1] == NULL)) goto bail;
-    keys  = malloc(elems * sizeof(CosName*));
-    values = malloc(elems * sizeof(CosNode*));
+    if (n % 2) return NULL;
     for (i = 0; i < elems; i ++) {
-        CosName* key = (CosName*) objects[2*i];
-        if (key->type != COS_NODE_NAME) goto bail;
-        keys[i] = key;
-        values[i] = objects[2*i + 1];
+        if (objects[2*i]->type != COS_NODE_NAME) return NULL;
     }
-    dict = cos_dict_new(keys, values, elems);
-bail:
-    _done_objects(objects, n);
-    if (keys) free(keys);
-    if (values) free(values);
-    return dict;
-}
 
-static CosDict* _parse_dict(CosParserCtx* ctx) {
-    size_t n = 0;
-    CosNode** objects = _parse_objects(ctx, &n, ">>");
-    return _pairs_to_dict(objects, n);
+    dict = cos_dict_new_in(ctx->arena, NULL, NULL, elems);
+    for (i = 0; i < elems; i ++) {
+        dict->keys[i] = (CosName*) objects[2*i];
+        dict->values[i] = objects[2*i + 1];
+    }
+    return dict;
 }
 
-static CosNode* _parse_object(CosParserCtx* ctx) {
+/* parse a simple object, or a string */
+static CosNode* _parse_simple_object(CosParserCtx* ctx) {
     CosNode* node = NULL;
     CosTk* tk1 = _look_ahead(ctx, 1);
-    char ch = ctx->buf[tk1->pos];
+    char ch = tk1->pos < ctx->buf_len ? ctx->buf[tk1->pos] : 0;
 
     switch (tk1->type) {
     case COS_TK_INT:
@@ -634,12 +763,12 @@ static CosNode* _parse_object(CosParserCtx* ctx) {
             /* indirect object <uint> <uint> R */
             uint64_t obj_num = _read_int(ctx, _shift(ctx));
             uint32_t gen_num = _read_int(ctx, _shift(ctx));
-            node = (CosNode*)cos_ref_new(obj_num, gen_num);
+            node = (CosNode*)cos_ref_new_in(ctx->arena, obj_num, gen_num);
         }
         else {
             /* continue with simple integer */
             PDF_TYPE_INT val = _read_int(ctx, tk1);
-            node = (CosNode*)cos_int_new(val);
+            node = (CosNode*)cos_int_new_in(ctx->arena, val);
         }
         break;
     case COS_TK_NAME:
@@ -647,22 +776,22 @@ static CosNode* _parse_object(CosParserCtx* ctx) {
         break;
     case COS_TK_REAL: {
         PDF_TYPE_REAL val = _read_real(ctx, tk1);
-        node = (CosNode*)cos_real_new(val);
+        node = (CosNode*)cos_real_new_in(ctx->arena, val);
         break;
     }
     case COS_TK_WORD:
         switch (tk1->len) {
         case 4:
             if (_at_token(ctx, tk1, "true")) {
-                node = (CosNode*)cos_bool_new(1);
+                node = (CosNode*)cos_bool_new_in(ctx->arena, 1);
             }
             else if (_at_token(ctx, tk1, "null")) {
-                node = (CosNode*)cos_null_new();
+                node = (CosNode*)cos_null_new_in(ctx->arena);
             }
             break;
         case 5:
             if (_at_token(ctx, tk1, "false")) {
-                node = (CosNode*)cos_bool_new(0);
+                node = (CosNode*)cos_bool_new_in(ctx->arena, 0);
             }
             break;
         }
@@ -673,25 +802,18 @@ static CosNode* _parse_object(CosParserCtx* ctx) {
     case COS_TK_DELIM:
         _shift(ctx);
         switch (ch) {
-        case '[': { /* '[' array ']' */
-            node = (void*) _parse_array(ctx);
-            break;
-        }
         case '(': { /* '(' string ')' */
             node = (void*) _parse_lit_string(ctx);
             break;
         }
         case '<': {
-            switch (tk1->len) {
-            case 1: /* '<' hex string '>' */
+            if (tk1->len == 1) {
+                /* '<' hex string '>' */
                 node = (void*) _parse_hex_string(ctx);
-                break;
-            case 2: /* '<<' dictionary '>>' */
-                node = (void*) _parse_dict(ctx);
-                break;
             }
             break;
         }
+        case '[': /* handled by _parse_object() */
         case ']': case '>':
         case '{': case '}':
             break;
@@ -713,33 +835,79 @@ static CosNode* _parse_object(CosParserCtx* ctx) {
     return node;
 }
 
-static CosNode** _parse_objects(CosParserCtx* ctx, size_t* n, char *stopper) {
-    CosNode** objects = NULL;
-    CosTk* tk = _look_ahead(ctx, 1);
-
-    if (_at_token(ctx, tk, stopper)) {
-        /* stopper reached */
-        if (n) {
-            objects = malloc(*n * sizeof(CosNode*));
-            memset(objects, 0, *n * sizeof(CosNode*));
+static int _at_container_start(CosParserCtx* ctx, CosTk* tk) {
+    if (tk->type == COS_TK_DELIM) {
+        switch (ctx->buf[tk->pos]) {
+        case '[': return 1;
+        case '<': return tk->len == 2;
         }
     }
-    else {
-        CosNode* object = _parse_object(ctx);
-        size_t i = (*n)++;
-        if (object) {
-            /* success, continue parsing */
-            objects = _parse_objects(ctx, n, stopper);
+    return 0;
+}
+
+/* Parse an object. Arrays and dictionaries are assembled on an explicit
+   stack, so the C stack doesn't grow with either their length or depth. */
+static CosNode* _parse_object(CosParserCtx* ctx) {
+    CosNodeVec objects = { NULL, 0, 0 };
+    CosParseFrame* frames = NULL;
+    size_t depth = 0;
+    size_t frames_size = 0;
+    CosNode* node;
+
+    for (;;) {
+        CosTk* tk = _look_ahead(ctx, 1);
+
+        if (_at_container_start(ctx, tk)) {
+            /* '[' array ']' or '<<' dictionary '>>' */
+            if (depth >= frames_size) {
+                frames_size = frames_size ? frames_size * 2 : 8;
+                frames = realloc(frames, frames_size * sizeof(CosParseFrame));
+            }
+            frames[depth].start = objects.elems;
+            frames[depth].ch = ctx->buf[tk->pos];
+            depth++;
+            _shift(ctx);
+            continue;
+        }
+        else if (depth && _at_token(ctx, tk, frames[depth-1].ch == '[' ? "]" : ">>")) {
+            CosParseFrame* frame = frames + --depth;
+            CosNode** members = objects.values + frame->start;
+            size_t n = objects.elems - frame->start;
+
+            node = frame->ch == '['
+                ? (CosNode*) _objects_to_array(ctx, members, n)
+                : (CosNode*) _pairs_to_dict(ctx, members, n);
+
+            if (node) {
+                /* references have been taken over by the container */
+                objects.elems = frame->start;
+            }
+            _shift(ctx);
         }
         else {
-            /* failure, stop parsing */
-            objects = malloc(*n * sizeof(CosNode*));
-            memset(objects, 0, *n * sizeof(CosNode*));
+            node = _parse_simple_object(ctx);
         }
-        objects[i] = object;
+
+        if (node == NULL || depth == 0) break;
+        _vec_push(&objects, node);
     }
 
-    return objects;
+    _vec_done(&objects);
+    if (frames) free(frames);
+
+    return node;
+}
+
+/* parse objects up to a stopper word, which isn't consumed */
+static int _parse_objects(CosParserCtx* ctx, CosNodeVec* objects, char *stopper) {
+    for (;;) {
+        CosNode* object;
+        if (_at_token(ctx, _look_ahead(ctx, 1), stopper)) return 1;
+
+        object = _parse_object(ctx);
+        if (object == NULL) return 0;
+        _vec_push(objects, object);
+    }
 }
 
 static int _valid_operand(CosNode* node) {
@@ -781,38 +949,38 @@ static int _valid_operand(CosNode* node) {
 }
 
 /* parse one operation, (operands followed by an operator), from a content stream */
-static CosOp* _parse_content_operation(CosParserCtx* ctx, size_t* m) {
+static CosOp* _parse_content_operation(CosParserCtx* ctx, CosNodeVec* operands) {
     CosOp* op = NULL;
-    CosTk* tk = _look_ahead(ctx, 1);
 
-    switch(tk->type) {
-    case COS_TK_WORD:
-        if (_at_op(ctx, tk)) {
-            op = cos_op_new(ctx->buf + tk->pos, tk->len, NULL, *m);
-            _shift(ctx);
-        }
-        break;
-    case COS_TK_DONE:
-        break;
-    default: {
-        size_t i = (*m)++;
-        CosNode* operand = _parse_object(ctx);
+    for (;;) {
+        CosTk* tk = _look_ahead(ctx, 1);
 
-        if (operand) {
-            if (_valid_operand(operand)) {
-                op = _parse_content_operation(ctx, m);
+        if (tk->type == COS_TK_WORD) {
+            if (_at_op(ctx, tk)) {
+                op = cos_op_new_in(ctx->arena, ctx->buf + tk->pos, tk->len, NULL, operands->elems);
+                if (operands->elems) memcpy(op->values, operands->values, operands->elems * sizeof(CosNode*));
+                /* references have been taken over by the op */
+                operands->elems = 0;
+                _shift(ctx);
             }
+            break;
+        }
+        else if (tk->type == COS_TK_DONE) {
+            break;
+        }
+        else {
+            CosNode* operand = _parse_object(ctx);
 
-            if (op) {
-                op->values[i] = operand;
-            }
-            else {
+            if (operand == NULL) break;
+            if (!_valid_operand(operand)) {
                 cos_node_done(operand);
+                break;
             }
+            _vec_push(operands, operand);
         }
     }
-    }
 
+    _vec_truncate(operands, 0);
     return op;
 }
 
@@ -823,20 +991,23 @@ static CosOp* _parse_content_operation(CosParserCtx* ctx, size_t* m) {
    - terminated by 'EI' (end image operator)
 */
 static CosInlineImage* _parse_inline_image(CosParserCtx* ctx) {
-    size_t n = 0;
-    CosNode** objects = _parse_objects(ctx, &n, "ID");
+    CosNodeVec objects = { NULL, 0, 0 };
     CosInlineImage* inline_image = NULL;
 
-    if (objects) {
+    if (_parse_objects(ctx, &objects, "ID")) {
         unsigned char* start_image = (unsigned char*) ctx->buf + ctx->buf_pos;
-        int ok = isspace(*(start_image++));
+        unsigned char* end = (unsigned char*) ctx->buf + ctx->buf_len;
+        /* 'ID' may be the last token */
+        int ok = start_image < end && PDF_CC(*(start_image++), PDF_CC_SPACE) != 0;
         CosDict* dict = NULL;
         size_t image_len = 0;
 
         if (ok) {
-            dict = _pairs_to_dict(objects, n);
+            dict = _pairs_to_dict(ctx, objects.values, objects.elems);
+            if (dict) objects.elems = 0;
             if (! _valid_operand((CosNode*)dict)) {
                 cos_node_done((CosNode*)dict);
+                _vec_done(&objects);
                 return NULL;
             }
         }
@@ -871,16 +1042,23 @@ static CosInlineImage* _parse_inline_image(CosParserCtx* ctx) {
             else {
                 /* we need to (gulp) scan for the end of image data */
                 /* look for terminating <ws>EI</b> */
-                unsigned char* p;
+                unsigned char* p = start_image;
                 unsigned char* end_image = NULL;
-                unsigned char* end = (unsigned char*) ctx->buf + ctx->buf_len - 2;
 
-                for (p = start_image; p < end && !end_image; p++) {
-                    if (isspace(p[0]) && p[1] == 'E' && p[2] == 'I') {
+                while (!end_image && p < end) {
+                    size_t n = end - p;
+                    size_t hit = pdf_scan_find((char*) p, n, "EI", 2);
+                    unsigned char* ei = p + hit;
+                    if (hit >= n) break;
+                    p = ei + 1;
+
+                    /* reject hits within binary data, before tokenizing */
+                    if (ei > start_image && PDF_CC(ei[-1], PDF_CC_SPACE)
+                        && (ei + 2 == end || PDF_CC(ei[2], PDF_CC_SPACE|PDF_CC_NUL|PDF_CC_DELIM))) {
                         /* Confirm we can actually parse 'EI' as a word */
-                        _resume_parse(ctx,  p);
+                        _resume_parse(ctx, ei - 1);
                         if (_at_token(ctx, _look_ahead(ctx, 1), "EI")) {
-                            end_image = p;
+                            end_image = ei - 1;
                         }
                     }
                 }
@@ -895,42 +1073,49 @@ static CosInlineImage* _parse_inline_image(CosParserCtx* ctx) {
         }
 
         if (ok) {
-            inline_image = cos_inline_image_new(dict, start_image, image_len);
+            inline_image = cos_inline_image_new_in(ctx->arena, dict, start_image, image_len);
         }
+        cos_node_done((CosNode*)dict);
 
         /* restart parse just before "EI" */
         _resume_parse(ctx, start_image + image_len);
     }
 
+    _vec_done(&objects);
     return inline_image;
 }
 
 /* parse content as a series of operations */
-static CosContent* _parse_content(CosParserCtx* ctx, size_t* n, int expect_inline) {
+static CosContent* _parse_content(CosParserCtx* ctx) {
+    CosNodeVec ops = { NULL, 0, 0 };
+    CosNodeVec operands = { NULL, 0, 0 };
     CosContent* content = NULL;
-    CosTk* tk = _look_ahead(ctx, 1);
-    if (tk->type == COS_TK_DONE) {
-        if (!expect_inline) {
-            content = cos_content_new(NULL, *n);
-        }
-    }
-    else {
-        size_t args = 0;
-        CosOp* opn = expect_inline ? (CosOp*) _parse_inline_image(ctx) : _parse_content_operation(ctx, &args);
-        if (opn) {
-            expect_inline = !expect_inline && opn->sub_type == COS_OP_BeginImage;
-            size_t i = (*n)++;
-            content = _parse_content(ctx, n, expect_inline);
-
-            if (content) {
-                content->values[i] = opn;
-            }
-            else {
-                cos_node_done((CosNode*)opn);
+    int expect_inline = 0;
+
+    for (;;) {
+        CosTk* tk = _look_ahead(ctx, 1);
+        CosOp* opn;
+
+        if (tk->type == COS_TK_DONE) {
+            if (!expect_inline) {
+                content = cos_content_new_in(ctx->arena, NULL, ops.elems);
+                if (ops.elems) memcpy(content->values, ops.values, ops.elems * sizeof(CosOp*));
+                /* references have been taken over by the content */
+                ops.elems = 0;
             }
+            break;
         }
+
+        opn = expect_inline ? (CosOp*) _parse_inline_image(ctx) : _parse_content_operation(ctx, &operands);
+        if (opn == NULL) break;
+
+        expect_inline = !expect_inline && opn->sub_type == COS_OP_BeginImage;
+        _vec_push(&ops, (CosNode*)opn);
     }
 
+    _vec_done(&ops);
+    _vec_done(&operands);
+
     return content;
 }
 
@@ -939,24 +1124,69 @@ static CosContent* _parse_content(CosParserCtx* ctx, size_t* n, int expect_inlin
  * avoid accidentally consuming binary data.
  */
 static size_t _locate_endstream(CosParserCtx* ctx, size_t start, char eoln[]) {
-    size_t p;
+    size_t end = ctx->buf_len;
     int trim = strlen(eoln);
     int auto_eoln = trim == 0;
 
-    for (p = ctx->buf_len - 10; p > start; p--) {
-        if (strncmp("endstream", ctx->buf + p, 9) == 0) {
-            if (auto_eoln || strncmp(eoln, ctx->buf + p - trim, trim) == 0) {
-                if (auto_eoln)  {
-                    if (p > start   && (ctx->buf[p-1] == '\n' || ctx->buf[p-1] == '\r')) trim++;
-                    if (p > start+1 && (ctx->buf[p-2] == '\n' || ctx->buf[p-2] == '\r')) trim++;
-                }
-                return p - trim;
+    while (end > start + 1) {
+        char* region = ctx->buf + start + 1;
+        size_t n = end - (start + 1);
+        size_t p = pdf_scan_rfind(region, n, "endstream", 9);
+        if (p >= n) break;
+        p += start + 1;
+
+        if (auto_eoln || strncmp(eoln, ctx->buf + p - trim, trim) == 0) {
+            if (auto_eoln)  {
+                if (p > start   && (ctx->buf[p-1] == '\n' || ctx->buf[p-1] == '\r')) trim++;
+                if (p > start+1 && (ctx->buf[p-2] == '\n' || ctx->buf[p-2] == '\r')) trim++;
             }
+            return p - trim;
         }
+        /* keep looking, before this one */
+        end = p + 8;
+    }
+    return 0;
+}
+
+/* Use a direct /Length entry, if it's followed by an optional EOL
+ * and 'endstream'. Returns the end of the stream data, or 0.
+ */
+static size_t _length_endstream(CosParserCtx* ctx, CosDict* dict, size_t start) {
+    static PDF_TYPE_CODE_POINT Length[6] = {'L', 'e', 'n', 'g', 't', 'h'};
+    CosName* len_entry = cos_name_new(Length, 6);
+    CosInt* len_lookup = (CosInt*) cos_dict_lookup(dict, len_entry);
+    size_t end, p;
+    cos_node_done((CosNode*)len_entry);
+
+    if (!len_lookup || len_lookup->type != COS_NODE_INT || len_lookup->value < 0
+        || (uint64_t) len_lookup->value > ctx->buf_len - start) {
+        return 0;
+    }
+
+    end = p = start + len_lookup->value;
+    if (p < ctx->buf_len && ctx->buf[p] == '\r') p++;
+    if (p < ctx->buf_len && ctx->buf[p] == '\n') p++;
+
+    if (p + 9 <= ctx->buf_len && strncmp(ctx->buf + p, "endstream", 9) == 0) {
+        return end;
     }
     return 0;
 }
 
+/* Search forwards for 'endstream', trimming a preceding EOL.
+ * Returns the end of the stream data, or 0.
+ */
+static size_t _next_endstream(CosParserCtx* ctx, size_t start) {
+    size_t n = ctx->buf_len - start;
+    size_t p = pdf_scan_find(ctx->buf + start, n, "endstream", 9);
+
+    if (p >= n) return 0;
+    p += start;
+    if (p > start && ctx->buf[p-1] == '\n') p--;
+    if (p > start && ctx->buf[p-1] == '\r') p--;
+    return p;
+}
+
 static CosIndObj* _parse_ind_obj(CosParserCtx* ctx, CosParseMode mode) {
     CosIndObj* ind_obj = NULL;
 
@@ -980,35 +1210,43 @@ static CosIndObj* _parse_ind_obj(CosParserCtx* ctx, CosParseMode mode) {
                 size_t stream_start = ctx->buf_pos;
 
                 if (mode == COS_PARSE_NIBBLE) {
-                    stream = cos_stream_new(dict, NULL, stream_start);
+                    stream = cos_stream_new_in(ctx->arena, dict, NULL, stream_start);
                 }
                 else {
                     /* Eager parsing of stream data */
-                    size_t stream_end = _locate_endstream(ctx, stream_start, eoln);
-                    if (!stream_end) stream_end = _locate_endstream(ctx, stream_start, auto_eoln);
+                    size_t stream_end = _length_endstream(ctx, dict, stream_start);
+                    if (mode == COS_PARSE_REPAIR) {
+                        /* further objects may follow; search forwards */
+                        if (!stream_end) stream_end = _next_endstream(ctx, stream_start);
+                    }
+                    else {
+                        if (!stream_end) stream_end = _locate_endstream(ctx, stream_start, eoln);
+                        if (!stream_end) stream_end = _locate_endstream(ctx, stream_start, auto_eoln);
+                    }
                     if (stream_end) {
                         uint8_t *value = (uint8_t*) ctx->buf + stream_start;
                         size_t length = stream_end - stream_start;
 
-                        stream = cos_stream_new(dict, value, length);
+                        stream = ctx->borrow
+                            ? cos_stream_borrow_in(ctx->arena, dict, value, length)
+                            : cos_stream_new_in(ctx->arena, dict, value, length);
 
                         _resume_parse(ctx, value + length);
                         _shift_word(ctx, "endstream");
                     }
                 }
 
-                if (!stream) cos_node_done((CosNode*)dict);
+                /* the stream holds its own reference to the dictionary */
+                cos_node_done((CosNode*)dict);
                 object = (void*) stream;
             }
         }
 
         if (object) {
-            if ((object->type == COS_NODE_STREAM && mode == COS_PARSE_NIBBLE) || _shift_word(ctx, "endobj")) {
-                ind_obj = cos_ind_obj_new(obj_num, gen_num, object);
-            }
-            else {
-                cos_node_done(object);
+            if ((object->type == COS_NODE_STREAM && mode == COS_PARSE_NIBBLE) || _shift_word(ctx, "endobj") || mode == COS_PARSE_REPAIR) {
+                ind_obj = cos_ind_obj_new_in(ctx->arena, obj_num, gen_num, object);
             }
+            cos_node_done(object);
         }
     }
 
@@ -1016,20 +1254,145 @@ static CosIndObj* _parse_ind_obj(CosParserCtx* ctx, CosParseMode mode) {
 }
 
 DLLEXPORT CosIndObj* cos_parse_ind_obj(char* in_buf, size_t in_len, CosParseMode mode) {
+    return cos_parse_ind_obj_in(NULL, in_buf, in_len, mode);
+}
+
+DLLEXPORT CosIndObj* cos_parse_ind_obj_in(CosArena* arena, char* in_buf, size_t in_len, CosParseMode mode) {
     CosTk tk1 = {COS_TK_START, 0, 0}, tk2 = {COS_TK_START, 0, 0}, tk3 = {COS_TK_START, 0, 0};
-    CosParserCtx ctx = { in_buf, in_len, 0, {&tk1, &tk2, &tk3}, 0};
+    CosParserCtx ctx = { in_buf, in_len, 0, {&tk1, &tk2, &tk3}, 0, arena, 0};
+    if (mode & COS_PARSE_BORROW) {
+        ctx.borrow = 1;
+        mode &= ~COS_PARSE_BORROW;
+    }
     return _parse_ind_obj(&ctx, mode);
 }
 
 DLLEXPORT CosNode* cos_parse_obj(char* in_buf, size_t in_len) {
+    return cos_parse_obj_in(NULL, in_buf, in_len);
+}
+
+DLLEXPORT CosNode* cos_parse_obj_in(CosArena* arena, char* in_buf, size_t in_len) {
     CosTk tk1 = {COS_TK_START, 0, 0}, tk2 = {COS_TK_START, 0, 0}, tk3 = {COS_TK_START, 0, 0};
-    CosParserCtx ctx = { in_buf, in_len, 0, {&tk1, &tk2, &tk3}, 0};
+    CosParserCtx ctx = { in_buf, in_len, 0, {&tk1, &tk2, &tk3}, 0, arena, 0};
     return _parse_object(&ctx);
 }
 
 DLLEXPORT CosContent* cos_parse_content(char* in_buf, size_t in_len) {
+    return cos_parse_content_in(NULL, in_buf, in_len);
+}
+
+DLLEXPORT CosContent* cos_parse_content_in(CosArena* arena, char* in_buf, size_t in_len) {
     CosTk tk1 = {COS_TK_START, 0, 0}, tk2 = {COS_TK_START, 0, 0}, tk3 = {COS_TK_START, 0, 0};
-    CosParserCtx ctx = { in_buf, in_len, 0, {&tk1, &tk2, &tk3}, 0};
-    size_t n = 0;
-    return _parse_content(&ctx, &n, 0);
+    CosParserCtx ctx = { in_buf, in_len, 0, {&tk1, &tk2, &tk3}, 0, arena, 0};
+    return _parse_content(&ctx);
+}
+
+/* Walk back from an 'obj' keyword, over '<uint> <uint> ', to the start
+ * of a possible indirect object header. Returns NULL if there isn't one.
+ */
+static char* _header_start(char* buf, char* kw) {
+    char* p = kw;
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        char* digits;
+        if (p == buf || !PDF_CC(p[-1], PDF_CC_SPACE|PDF_CC_NUL)) return NULL;
+        while (p > buf && PDF_CC(p[-1], PDF_CC_SPACE|PDF_CC_NUL)) p--;
+        digits = p;
+        while (p > buf && PDF_CC(p[-1], PDF_CC_DIGIT)) p--;
+        if (p == digits) return NULL;
+    }
+    if (p > buf && PDF_CC(p[-1], PDF_CC_REGULAR)) return NULL;
+
+    return p;
+}
+
+/* order by object number, then offset */
+static int _cmp_xref_entries(const void* a, const void* b) {
+    const uint64_t* e1 = a;
+    const uint64_t* e2 = b;
+    if (e1[0] != e2[0]) return e1[0] < e2[0] ? -1 : 1;
+    if (e1[2] != e2[2]) return e1[2] < e2[2] ? -1 : 1;
+    return 0;
+}
+
+/* scan for indirect objects; returns the entries, ordered and without
+ * duplicates, setting *n_found */
+static uint64_t* _repair(char* in_buf, size_t in_len, size_t* n_found) {
+    CosTk tk1 = {COS_TK_START, 0, 0}, tk2 = {COS_TK_START, 0, 0}, tk3 = {COS_TK_START, 0, 0};
+    CosParserCtx ctx = { in_buf, in_len, 0, {&tk1, &tk2, &tk3}, 0, NULL, 1};
+    uint64_t* entries = NULL;
+    size_t n_entries = 0;
+    size_t size = 0;
+    size_t pos = 0;
+    size_t i, n;
+
+    while (pos < in_len) {
+        size_t hit = pdf_scan_find(in_buf + pos, in_len - pos, "obj", 3);
+        char* start;
+        if (hit >= in_len - pos) break;
+
+        start = _header_start(in_buf, in_buf + pos + hit);
+        pos += hit + 3;
+        if (!start) continue;
+
+        _resume_parse(&ctx, start);
+        if (_at_uint(&ctx, _look_ahead(&ctx, 1)) && _at_uint(&ctx, _look_ahead(&ctx, 2)) && _at_token(&ctx, _look_ahead(&ctx, 3), "obj")) {
+            CosIndObj* ind_obj;
+            if (n_entries >= size) {
+                uint64_t* grown;
+                size = size ? size * 2 : 256;
+                grown = realloc(entries, size * 4 * sizeof(uint64_t));
+                if (grown == NULL) {
+                    fprintf(stderr, __FILE__ ":%d out of memory\n", __LINE__);
+                    break;
+                }
+                entries = grown;
+            }
+            entries[4*n_entries]     = _read_int(&ctx, _look_ahead(&ctx, 1));
+            entries[4*n_entries + 1] = 1;
+            entries[4*n_entries + 2] = start - in_buf;
+            entries[4*n_entries + 3] = _read_int(&ctx, _look_ahead(&ctx, 2));
+            n_entries++;
+
+            /* skip over the object, including any stream data */
+            ind_obj = _parse_ind_obj(&ctx, COS_PARSE_REPAIR);
+            if (ind_obj) {
+                if (ctx.buf_pos > pos) pos = ctx.buf_pos;
+                cos_node_done((CosNode*)ind_obj);
+            }
+        }
+    }
+
+    if (n_entries) qsort(entries, n_entries, 4 * sizeof(uint64_t), _cmp_xref_entries);
+
+    /* later definitions win */
+    for (i = 0, n = 0; i < n_entries; i++) {
+        uint64_t* entry = entries + 4*i;
+        if (i + 1 < n_entries && entry[4] == entry[0]) continue;
+        if (n < i) memcpy(entries + 4*n, entry, 4 * sizeof(uint64_t));
+        n++;
+    }
+
+    *n_found = n;
+    return entries;
+}
+
+DLLEXPORT size_t cos_parse_repair(PDF_TYPE_XREF xref, size_t max_entries, char* in_buf, size_t in_len) {
+    size_t n;
+    uint64_t* entries = _repair(in_buf, in_len, &n);
+
+    if (entries) {
+        memcpy(xref, entries, (n < max_entries ? n : max_entries) * 4 * sizeof(uint64_t));
+        free(entries);
+    }
+    return n;
+}
+
+DLLEXPORT PDF_TYPE_XREF cos_parse_repair_alloc(char* in_buf, size_t in_len, size_t* n_entries) {
+    return _repair(in_buf, in_len, n_entries);
+}
+
+DLLEXPORT void cos_parse_repair_free(PDF_TYPE_XREF entries) {
+    free(entries);
 }
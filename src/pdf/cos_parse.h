@@ -4,11 +4,26 @@
 typedef enum {
     COS_PARSE_NIBBLE,
     COS_PARSE_SCAN,
-    COS_PARSE_REPAIR
+    COS_PARSE_REPAIR,
+    COS_PARSE_BORROW = 0x10 /* flag: reference stream data and strings in the input buffer */
 } CosParseMode;
 
 DLLEXPORT CosIndObj* cos_parse_ind_obj(char*, size_t, CosParseMode);
 DLLEXPORT CosNode* cos_parse_obj(char *, size_t);
 DLLEXPORT CosContent* cos_parse_content(char* in_buf, size_t in_len);
 
+DLLEXPORT CosIndObj* cos_parse_ind_obj_in(CosArena*, char*, size_t, CosParseMode);
+DLLEXPORT CosNode* cos_parse_obj_in(CosArena*, char *, size_t);
+DLLEXPORT CosContent* cos_parse_content_in(CosArena*, char* in_buf, size_t in_len);
+
+/* rebuild an index of indirect objects, as [obj-num, 1, offset, gen-num]
+   quads, ordered by object number. Later definitions win. Writes up to
+   the given number of entries; returns the number found */
+DLLEXPORT size_t cos_parse_repair(PDF_TYPE_XREF, size_t, char*, size_t);
+
+/* as above, returning all of the entries found, and setting their number.
+   Free with cos_parse_repair_free() */
+DLLEXPORT PDF_TYPE_XREF cos_parse_repair_alloc(char*, size_t, size_t*);
+DLLEXPORT void cos_parse_repair_free(PDF_TYPE_XREF);
+
 #endif
@@ -0,0 +1,703 @@
+/* Streaming serialization of COS nodes.
+ *
+ * This mirrors the cos_*_write() functions in cos.c, which remain the
+ * reference for the output format. Rather than writing to a caller's
+ * buffer, output goes to a small fixed buffer, which is flushed to a
+ * callback or file descriptor as it fills.
+ *
+ * A few of the buffer writers retract a trailing newline after the fact.
+ * To support this, flushing always holds back the last byte.
+ */
+
+#include "pdf.h"
+#include "pdf/cos.h"
+#include "pdf/cos_write.h"
+#include "pdf/write.h"
+#include "pdf/buf.h"
+#include "pdf/filt_flate.h"
+#include "pdf/filt_predict.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define _fd_write(fd, buf, len) _write((fd), (buf), (unsigned int)(len))
+#else
+#include <unistd.h>
+#define _fd_write(fd, buf, len) write((fd), (buf), (len))
+#endif
+
+/* input bytes per chunk, when writing escaped strings */
+#define COS_WRITER_CHUNK 1024
+/* a dictionary that doesn't fit in this is always wrapped; see _write_dict() */
+#define COS_WRITER_DICT_PROBE 128
+#define COS_WRITER_MIN_BUF 64
+
+static CosWriter* _writer_new(CosWriteFunc write_cb, void* user_data, int fd, size_t buf_size) {
+    CosWriter* self = malloc(sizeof(CosWriter));
+    if (buf_size == 0) buf_size = COS_WRITER_BUF_SIZE;
+    if (buf_size < COS_WRITER_MIN_BUF) buf_size = COS_WRITER_MIN_BUF;
+    self->write_cb = write_cb;
+    self->user_data = user_data;
+    self->fd = fd;
+    self->error = 0;
+    self->buf = malloc(buf_size);
+    self->buf_size = buf_size;
+    self->buf_len = 0;
+    self->pos = 0;
+    return self;
+}
+
+DLLEXPORT CosWriter* cos_writer_new(CosWriteFunc write_cb, void* user_data, size_t buf_size) {
+    return _writer_new(write_cb, user_data, -1, buf_size);
+}
+
+DLLEXPORT CosWriter* cos_writer_new_fd(int fd, size_t buf_size) {
+    return _writer_new(NULL, NULL, fd, buf_size);
+}
+
+/* output all but the last 'keep' buffered bytes */
+static void _flush(CosWriter* self, size_t keep) {
+    size_t len = self->buf_len - keep;
+    size_t n = 0;
+
+    if (self->error || len == 0) return;
+
+    if (self->write_cb) {
+        n = self->write_cb(self, self->buf, len);
+    }
+    else {
+        while (n < len) {
+            long m = _fd_write(self->fd, self->buf + n, len - n);
+            if (m <= 0) break;
+            n += m;
+        }
+    }
+
+    if (n != len) {
+        fprintf(stderr, __FILE__ ":%d write failed\n", __LINE__);
+        self->error = 1;
+        return;
+    }
+
+    memmove(self->buf, self->buf + len, keep);
+    self->buf_len = keep;
+}
+
+static void _put(CosWriter* self, const char* p, size_t len) {
+    while (len && !self->error) {
+        size_t n;
+        if (self->buf_len >= self->buf_size) _flush(self, 1);
+        n = self->buf_size - self->buf_len;
+        if (n > len) n = len;
+        memcpy(self->buf + self->buf_len, p, n);
+        self->buf_len += n;
+        self->pos += n;
+        p += n;
+        len -= n;
+    }
+}
+
+static void _putc(CosWriter* self, char c) {
+    _put(self, &c, 1);
+}
+
+static void _puts(CosWriter* self, const char* s) {
+    _put(self, s, strlen(s));
+}
+
+/* retract the last byte */
+static void _unput(CosWriter* self) {
+    if (self->buf_len) {
+        self->buf_len--;
+        self->pos--;
+    }
+}
+
+static void _spaces(CosWriter* self, int n) {
+    for (; n > 0; n--) _putc(self, ' ');
+}
+
+static int _last_char(CosWriter* self) {
+    return self->buf_len ? self->buf[self->buf_len - 1] : -1;
+}
+
+typedef size_t (*_StringWriter) (PDF_TYPE_STRING, size_t, char*, size_t);
+
+/* write an escaped string, in chunks, omitting the per-chunk delimiters */
+static void _write_string(CosWriter* self, _StringWriter writer, char open, char close, PDF_TYPE_STRING value, size_t value_len) {
+    char out[COS_WRITER_CHUNK * 2 + 2];
+    size_t i;
+
+    _putc(self, open);
+    for (i = 0; i < value_len && !self->error; i += COS_WRITER_CHUNK) {
+        size_t len = value_len - i < COS_WRITER_CHUNK ? value_len - i : COS_WRITER_CHUNK;
+        size_t n = writer(value + i, len, out, sizeof(out));
+        if (n < 2) {
+            self->error = 1;
+            break;
+        }
+        _put(self, out + 1, n - 2);
+    }
+    _putc(self, close);
+}
+
+/* as pdf_write_comment() */
+static void _write_comment(CosWriter* self, PDF_TYPE_STRING value, size_t value_len) {
+    PDF_TYPE_STRING in_p = value;
+    PDF_TYPE_STRING in_end = value + value_len;
+
+    _puts(self, "% ");
+
+    while (in_p < in_end) {
+        char ch = *(in_p++);
+        if (ch == '\r' || ch == '\n') {
+            if (ch == '\r' && in_p < in_end && *(in_p) == '\n') in_p++;
+            _puts(self, "\n% ");
+        }
+        else {
+            _putc(self, ch);
+        }
+    }
+    _putc(self, '\n');
+}
+
+static void _write_node(CosWriter*, CosNode*, int);
+
+static void _write_name(CosWriter* self, CosName* name) {
+    char out[16];
+    uint16_t i;
+
+    _putc(self, '/');
+    for (i = 0; i < name->value_len; i++) {
+        int n = pdf_write_name_code(name->value[i], out, sizeof(out));
+        _put(self, out, n);
+    }
+}
+
+static void _write_dict(CosWriter* self, CosDict* dict, int indent) {
+    int elem_indent = indent >= 0 ? indent + 2 : -1;
+    size_t i;
+
+    if (elem_indent > 0) {
+        /* cos_dict_write() wraps a dictionary that is at least
+           MultiLineDictWrap characters, excluding separators. A single line
+           dictionary can't exceed the probe size, so try that first. */
+        char out[COS_WRITER_DICT_PROBE];
+        size_t n = cos_dict_write(dict, out, sizeof(out), indent);
+        if (n) {
+            _put(self, out, n);
+        }
+        else {
+            _puts(self, "<<");
+            for (i = 0; i < dict->elems; i++) {
+                _putc(self, '\n');
+                _spaces(self, elem_indent);
+                _write_node(self, (CosNode*)dict->keys[i], 0);
+                _putc(self, ' ');
+                _write_node(self, dict->values[i], elem_indent);
+            }
+            _putc(self, '\n');
+            _spaces(self, indent);
+            _puts(self, ">>");
+        }
+    }
+    else {
+        _puts(self, "<< ");
+        for (i = 0; i < dict->elems; i++) {
+            _write_node(self, (CosNode*)dict->keys[i], 0);
+            _putc(self, ' ');
+            _write_node(self, dict->values[i], elem_indent);
+            _putc(self, ' ');
+        }
+        _puts(self, ">>");
+    }
+}
+
+static void _write_op(CosWriter* self, CosOp* op, int indent) {
+    CosNode* comment = NULL;
+    size_t i;
+
+    if (op->sub_type != COS_OP_EndImage) _spaces(self, indent);
+
+    for (i = 0; i < op->elems; i++) {
+        if (op->values[i]->type == COS_NODE_COMMENT) {
+            comment = op->values[i];
+        }
+        else {
+            int is_inline_image = op->values[i]->type == COS_NODE_INLINE_IMAGE;
+            _write_node(self, op->values[i], is_inline_image ? indent : 0);
+            _putc(self, is_inline_image ? '\n' : ' ');
+        }
+    }
+
+    _puts(self, op->opn);
+
+    if (comment) {
+        _write_node(self, comment, 1);
+        _unput(self);
+    }
+}
+
+/* as cos_content_write() */
+static int _op_nesting(CosOp* op) {
+    if (op->type == COS_NODE_OP) {
+        switch (op->sub_type) {
+        case COS_OP_Save:
+        case COS_OP_BeginText:
+        case COS_OP_BeginExtended:
+        case COS_OP_BeginMarkedContent:
+        case COS_OP_BeginMarkedContentDict:
+            return 1;
+        case COS_OP_Restore:
+        case COS_OP_EndText:
+        case COS_OP_EndExtended:
+        case COS_OP_EndMarkedContent:
+            return -1;
+        default:
+            break;
+        }
+    }
+    return 0;
+}
+
+static void _write_content(CosWriter* self, CosContent* content) {
+    int indent = 0;
+    size_t i;
+
+    for (i = 0; i < content->elems; i++) {
+        CosOp* op = content->values[i];
+        int ch = _op_nesting(op);
+
+        if (i > 0) _putc(self, '\n');
+        if (ch < 0 && indent > 1) indent -= 2;
+        _write_node(self, (CosNode*)op, indent);
+        if (_last_char(self) == '\n') _unput(self);
+        if (ch > 0 && indent >= 0) indent += 2;
+    }
+}
+
+static void _write_node(CosWriter* self, CosNode* node, int indent) {
+    char out[64];
+    size_t n = 0;
+
+    if (self->error) return;
+
+    switch (node ? node->type : COS_NODE_NULL) {
+    case COS_NODE_IND_OBJ:
+        {
+            CosIndObj* ind_obj = (void*)node;
+            n = pdf_write_int((PDF_TYPE_INT64)ind_obj->obj_num, out, sizeof(out));
+            out[n++] = ' ';
+            n += pdf_write_int(ind_obj->gen_num, out+n, sizeof(out)-n);
+            _put(self, out, n);
+            _puts(self, " obj\n");
+            _write_node(self, ind_obj->value, 0);
+            _puts(self, "\nendobj\n");
+        }
+        return;
+    case COS_NODE_INT:
+        n = cos_int_write((CosInt*)node, out, sizeof(out));
+        break;
+    case COS_NODE_BOOL:
+        n = cos_bool_write((CosBool*)node, out, sizeof(out));
+        break;
+    case COS_NODE_NULL:
+        n = cos_null_write((CosNull*)node, out, sizeof(out));
+        break;
+    case COS_NODE_REAL:
+        n = cos_real_write((CosReal*)node, out, sizeof(out));
+        break;
+    case COS_NODE_REF:
+        n = cos_ref_write((CosRef*)node, out, sizeof(out));
+        break;
+    case COS_NODE_ARRAY:
+        {
+            CosArray* array = (void*)node;
+            size_t i;
+            _puts(self, "[ ");
+            for (i = 0; i < array->elems; i++) {
+                _write_node(self, array->values[i], indent);
+                _putc(self, ' ');
+            }
+            _putc(self, ']');
+        }
+        return;
+    case COS_NODE_DICT:
+        _write_dict(self, (CosDict*)node, indent);
+        return;
+    case COS_NODE_NAME:
+        _write_name(self, (CosName*)node);
+        return;
+    case COS_NODE_LIT_STR:
+        {
+            CosLiteralStr* s = (void*)node;
+            _write_string(self, pdf_write_literal, '(', ')', s->value, s->value_len);
+        }
+        return;
+    case COS_NODE_HEX_STR:
+        {
+            CosHexString* s = (void*)node;
+            _write_string(self, pdf_write_hex_string, '<', '>', s->value, s->value_len);
+        }
+        return;
+    case COS_NODE_STREAM:
+        {
+            CosStream* stream = (void*)node;
+            _write_dict(self, stream->dict, 0);
+            _puts(self, " stream\n");
+            if (stream->value) {
+                _put(self, stream->value, stream->value_len);
+                _puts(self, "\nendstream");
+            }
+        }
+        return;
+    case COS_NODE_OP:
+        _write_op(self, (CosOp*)node, indent);
+        return;
+    case COS_NODE_INLINE_IMAGE:
+        {
+            CosInlineImage* image = (void*)node;
+            CosDict* dict = image->dict;
+            size_t i;
+            _spaces(self, indent);
+            for (i = 0; i < dict->elems; i++) {
+                _write_node(self, (CosNode*)dict->keys[i], -1);
+                _putc(self, ' ');
+                _write_node(self, dict->values[i], -1);
+                _putc(self, ' ');
+            }
+            _puts(self, "ID\n");
+            _put(self, image->value, image->value_len);
+        }
+        return;
+    case COS_NODE_CONTENT:
+        _write_content(self, (CosContent*)node);
+        return;
+    case COS_NODE_COMMENT:
+        {
+            CosComment* comment = (void*)node;
+            _spaces(self, indent);
+            _write_comment(self, comment->value, comment->value_len);
+        }
+        return;
+    default:
+        fprintf(stderr, __FILE__ ":%d type not yet handled: %d\n", __LINE__, node->type);
+        break;
+    }
+
+    if (n == 0) {
+        self->error = 1;
+    }
+    else {
+        _put(self, out, n);
+    }
+}
+
+DLLEXPORT size_t cos_writer_put(CosWriter* self, char* buf, size_t len) {
+    size_t pos = self->pos;
+    _put(self, buf, len);
+    return self->error ? 0 : self->pos - pos;
+}
+
+DLLEXPORT size_t cos_writer_write(CosWriter* self, CosNode* node, int indent) {
+    size_t pos = self->pos;
+    _write_node(self, node, indent);
+    return self->error ? 0 : self->pos - pos;
+}
+
+DLLEXPORT int cos_writer_flush(CosWriter* self) {
+    _flush(self, 0);
+    return self->error ? -1 : 0;
+}
+
+typedef struct {
+    uint64_t obj_num;
+    uint64_t offset;
+    uint32_t gen_num;
+} _XRefEntry;
+
+static int _cmp_xref_entries(const void* a, const void* b) {
+    uint64_t n1 = ((_XRefEntry*)a)->obj_num;
+    uint64_t n2 = ((_XRefEntry*)b)->obj_num;
+    return n1 < n2 ? -1 : (n1 > n2 ? 1 : 0);
+}
+
+static CosName* _name(const char* s) {
+    PDF_TYPE_CODE_POINT value[COS_NAME_INTERN_MAX_LEN];
+    uint16_t i;
+    for (i = 0; s[i]; i++) value[i] = (unsigned char) s[i];
+    return cos_name_new(value, i);
+}
+
+static int _name_is(CosName* name, const char* s) {
+    uint16_t i;
+    for (i = 0; i < name->value_len; i++) {
+        if (name->value[i] != (unsigned char) s[i]) return 0;
+    }
+    return s[i] == 0;
+}
+
+/* a new dictionary. The given entries come first, followed by any entries
+ * from 'trailer' that aren't in 'skip' */
+static CosDict* _trailer_new(CosDict* trailer, char** keys, CosNode** values, size_t n, char** skip) {
+    size_t elems = n + (trailer ? trailer->elems : 0);
+    CosName** dict_keys = malloc(elems * sizeof(CosName*));
+    CosNode** dict_values = malloc(elems * sizeof(CosNode*));
+    CosDict* dict;
+    size_t i, m = 0;
+
+    for (i = 0; i < n; i++) {
+        dict_keys[m] = _name(keys[i]);
+        dict_values[m++] = values[i];
+    }
+
+    for (i = 0; trailer && i < trailer->elems; i++) {
+        CosName* key = trailer->keys[i];
+        char** k;
+        if (trailer->values[i] == NULL) continue;
+        for (k = skip; *k && !_name_is(key, *k); k++);
+        if (*k) continue;
+        cos_node_reference((CosNode*)key);
+        dict_keys[m] = key;
+        dict_values[m++] = trailer->values[i];
+    }
+
+    dict = cos_dict_new(dict_keys, dict_values, m);
+
+    /* the dictionary now holds its own references */
+    for (i = 0; i < m; i++) {
+        cos_node_done((CosNode*)dict_keys[i]);
+    }
+    for (i = 0; i < n; i++) {
+        cos_node_done(values[i]);
+    }
+    free(dict_keys);
+    free(dict_values);
+    return dict;
+}
+
+static void _write_startxref(CosWriter* self, uint64_t offset) {
+    char out[32];
+    size_t n = pdf_write_int((PDF_TYPE_INT64)offset, out, sizeof(out));
+    _puts(self, "startxref\n");
+    _put(self, out, n);
+    _puts(self, "\n%%EOF\n");
+}
+
+#define COS_WRITER_XREF_ROWS 64
+
+static void _write_xref_table(CosWriter* self, _XRefEntry* entries, size_t rows, CosDict* trailer) {
+    static char* skip[] = {"Size", NULL};
+    char* keys[] = {"Size"};
+    CosNode* values[1];
+    uint64_t offset = self->pos;
+    uint64_t xref[COS_WRITER_XREF_ROWS * 3];
+    char out[COS_WRITER_XREF_ROWS * 20];
+    CosDict* dict;
+    size_t i = 0;
+
+    _puts(self, "xref\n");
+
+    while (i < rows) {
+        /* subsection of consecutively numbered objects */
+        size_t j = i + 1;
+        size_t n;
+        while (j < rows && entries[j].obj_num == entries[j-1].obj_num + 1) j++;
+
+        n = pdf_write_int((PDF_TYPE_INT64)entries[i].obj_num, out, sizeof(out));
+        out[n++] = ' ';
+        n += pdf_write_int(j - i, out+n, sizeof(out)-n);
+        out[n++] = '\n';
+        _put(self, out, n);
+
+        while (i < j) {
+            size_t k;
+            for (k = 0; k < COS_WRITER_XREF_ROWS && i < j; k++, i++) {
+                xref[3*k] = entries[i].offset;
+                xref[3*k + 1] = entries[i].gen_num;
+                xref[3*k + 2] = entries[i].obj_num != 0;
+            }
+            n = pdf_write_xref_seg(xref, k, out, sizeof(out));
+            _put(self, out, n);
+        }
+    }
+
+    values[0] = (CosNode*)cos_int_new(entries[rows-1].obj_num + 1);
+    dict = _trailer_new(trailer, keys, values, 1, skip);
+    _puts(self, "trailer\n");
+    _write_node(self, (CosNode*)dict, 0);
+    _putc(self, '\n');
+    cos_node_done((CosNode*)dict);
+
+    _write_startxref(self, offset);
+}
+
+static CosArray* _int_array_new(uint64_t* values, size_t elems) {
+    CosNode** nodes = malloc(elems * sizeof(CosNode*));
+    CosArray* array;
+    size_t i;
+
+    for (i = 0; i < elems; i++) {
+        nodes[i] = (CosNode*)cos_int_new((PDF_TYPE_INT)values[i]);
+    }
+    array = cos_array_new(nodes, elems);
+    for (i = 0; i < elems; i++) {
+        cos_node_done(nodes[i]);
+    }
+    free(nodes);
+    return array;
+}
+
+/* the last entry is for the cross reference stream itself. With zlib, the
+ * rows are compressed, with the PNG Up predictor */
+static void _write_xref_stream(CosWriter* self, _XRefEntry* entries, size_t rows, CosDict* trailer) {
+    static char* skip[] = {"Type", "Size", "Index", "W", "Length", "Filter", "DecodeParms", NULL};
+    char* keys[7];
+    CosNode* values[7];
+    size_t n_values = 0;
+    uint64_t* in = malloc(rows * 4 * sizeof(uint64_t));
+    uint64_t* out = malloc(rows * 3 * sizeof(uint64_t));
+    uint32_t* index = malloc(rows * 2 * sizeof(uint32_t));
+    uint64_t w64[3];
+    uint8_t w[3];
+    uint8_t* data;
+    size_t index_len, data_len, i;
+    uint32_t size;
+    CosDict* dict;
+    CosStream* stream;
+    CosIndObj* ind_obj;
+    uint64_t* index_values;
+
+    for (i = 0; i < rows; i++) {
+        in[4*i] = entries[i].obj_num;
+        in[4*i + 1] = entries[i].obj_num != 0;
+        in[4*i + 2] = entries[i].offset;
+        in[4*i + 3] = entries[i].gen_num;
+    }
+
+    size = pdf_buf_pack_xref_stream(in, out, rows, index, &index_len);
+    pdf_buf_pack_compute_W_64(out, rows * 3, w, 3);
+    data_len = rows * (w[0] + w[1] + w[2]);
+    data = malloc(data_len ? data_len : 1);
+    pdf_buf_pack_W_64(out, data, rows * 3, w, 3);
+
+    index_values = malloc(index_len * sizeof(uint64_t));
+    for (i = 0; i < index_len; i++) index_values[i] = index[i];
+    for (i = 0; i < 3; i++) w64[i] = w[i];
+
+    keys[n_values] = "Type";
+    values[n_values++] = (CosNode*)_name("XRef");
+    keys[n_values] = "Size";
+    values[n_values++] = (CosNode*)cos_int_new(size);
+    keys[n_values] = "Index";
+    values[n_values++] = (CosNode*)_int_array_new(index_values, index_len);
+    keys[n_values] = "W";
+    values[n_values++] = (CosNode*)_int_array_new(w64, 3);
+
+#ifdef PDF_ZLIB
+    {
+        uint16_t columns = w[0] + w[1] + w[2];
+        uint8_t* flated;
+        size_t flated_len;
+
+        if (columns && pdf_filt_flate_encode(data, data_len, &flated, &flated_len,
+                                             PDF_FILTER_PNG_UP_ALL_ROWS, 1, 8, columns, -1) == 0) {
+            char* parms_keys[] = {"Predictor", "Columns"};
+            CosNode* parms_values[2];
+            parms_values[0] = (CosNode*)cos_int_new(PDF_FILTER_PNG_UP_ALL_ROWS);
+            parms_values[1] = (CosNode*)cos_int_new(columns);
+            keys[n_values] = "Filter";
+            values[n_values++] = (CosNode*)_name("FlateDecode");
+            keys[n_values] = "DecodeParms";
+            values[n_values++] = (CosNode*)_trailer_new(NULL, parms_keys, parms_values, 2, skip);
+            free(data);
+            data = flated;
+            data_len = flated_len;
+        }
+    }
+#endif
+
+    keys[n_values] = "Length";
+    values[n_values++] = (CosNode*)cos_int_new(data_len);
+    dict = _trailer_new(trailer, keys, values, n_values, skip);
+
+    stream = cos_stream_borrow(dict, data, data_len);
+    ind_obj = cos_ind_obj_new(entries[rows-1].obj_num, 0, (CosNode*)stream);
+    _write_node(self, (CosNode*)ind_obj, 0);
+
+    cos_node_done((CosNode*)ind_obj);
+    cos_node_done((CosNode*)stream);
+    cos_node_done((CosNode*)dict);
+
+    _write_startxref(self, entries[rows-1].offset);
+
+    free(index_values);
+    free(data);
+    free(index);
+    free(out);
+    free(in);
+}
+
+DLLEXPORT size_t cos_writer_write_pdf(CosWriter* self, char* version, CosIndObj** objs, size_t objs_len, CosDict* trailer, int flags) {
+    size_t pos = self->pos;
+    /* free entry 0, objects, and maybe the xref stream */
+    _XRefEntry* entries = malloc((objs_len + 2) * sizeof(_XRefEntry));
+    size_t rows = 0;
+    size_t i;
+
+    if (version) {
+        _puts(self, "%PDF-");
+        _puts(self, version);
+        _puts(self, "\n%\xE2\xE3\xCF\xD3\n");
+    }
+
+    entries[rows].obj_num = 0;
+    entries[rows].offset = 0;
+    entries[rows++].gen_num = 65535;
+
+    for (i = 0; i < objs_len && !self->error; i++) {
+        CosIndObj* obj = objs[i];
+        if (obj == NULL || obj->type != COS_NODE_IND_OBJ || obj->obj_num == 0) {
+            fprintf(stderr, __FILE__ ":%d invalid indirect object\n", __LINE__);
+            self->error = 1;
+            break;
+        }
+        entries[rows].obj_num = obj->obj_num;
+        entries[rows].offset = self->pos;
+        entries[rows++].gen_num = obj->gen_num;
+        _write_node(self, (CosNode*)obj, 0);
+    }
+
+    qsort(entries, rows, sizeof(_XRefEntry), _cmp_xref_entries);
+
+    for (i = 1; i < rows && !self->error; i++) {
+        if (entries[i].obj_num == entries[i-1].obj_num) {
+            fprintf(stderr, __FILE__ ":%d duplicate object number: %" PRIu64 "\n", __LINE__, entries[i].obj_num);
+            self->error = 1;
+        }
+    }
+
+    if (!self->error) {
+        if (flags & COS_WRITE_XREF_STREAM) {
+            entries[rows].obj_num = entries[rows-1].obj_num + 1;
+            entries[rows].offset = self->pos;
+            entries[rows++].gen_num = 0;
+            _write_xref_stream(self, entries, rows, trailer);
+        }
+        else {
+            _write_xref_table(self, entries, rows, trailer);
+        }
+    }
+
+    free(entries);
+    return self->error ? 0 : self->pos - pos;
+}
+
+DLLEXPORT void cos_writer_done(CosWriter* self) {
+    cos_writer_flush(self);
+    free(self->buf);
+    free(self);
+}
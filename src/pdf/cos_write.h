@@ -0,0 +1,66 @@
+#ifndef PDF_COS_WRITE_H_
+#define PDF_COS_WRITE_H_
+
+#include "pdf/cos.h"
+
+/* Streaming serialization of COS nodes. Output is accumulated in a fixed
+ * size buffer and flushed to a callback, or a file descriptor, as it fills.
+ * It is the same as from the cos_*_write() functions, but without needing
+ * cos_node_get_write_size() or a buffer for the whole object. */
+
+typedef struct _CosWriter CosWriter;
+
+/* returns the number of bytes written; anything short is an error */
+typedef size_t (*CosWriteFunc) (CosWriter*, char*, size_t);
+
+struct _CosWriter {
+    CosWriteFunc write_cb;
+    void*    user_data;
+    int      fd;          /* written to when there is no callback */
+    int      error;
+    char*    buf;
+    size_t   buf_size;
+    size_t   buf_len;
+    size_t   pos;         /* total bytes output, including buffered */
+};
+
+#define COS_WRITER_BUF_SIZE 8192
+
+DLLEXPORT CosWriter* cos_writer_new(CosWriteFunc, void* user_data, size_t buf_size);
+DLLEXPORT CosWriter* cos_writer_new_fd(int fd, size_t buf_size);
+/* flushes, then frees the writer */
+DLLEXPORT void cos_writer_done(CosWriter*);
+
+/* writes raw bytes. returns the number of bytes, or 0 on error */
+DLLEXPORT size_t cos_writer_put(CosWriter*, char*, size_t);
+/* serializes a node. returns the number of bytes, or 0 on error */
+DLLEXPORT size_t cos_writer_write(CosWriter*, CosNode*, int indent);
+/* returns 0, or -1 on error */
+DLLEXPORT int cos_writer_flush(CosWriter*);
+
+/* cos_writer_write_pdf() flags */
+#define COS_WRITE_XREF_STREAM 1
+
+/* Writes a whole PDF: a header for the given version (omitted if NULL), the
+ * objects, a cross reference table or stream, the trailer and startxref.
+ * /Size, and for streams /Type, /Index, /W and /Length, are computed; other
+ * trailer entries are copied. Offsets are taken from the writer's pos, which
+ * may be preset when appending an update. Returns the number of bytes, or 0
+ * on error. */
+DLLEXPORT size_t cos_writer_write_pdf(CosWriter*, char* version, CosIndObj**, size_t, CosDict* trailer, int flags);
+
+/* Indirect objects, serialized to a contiguous buffer by cos_write_batch() */
+typedef struct {
+    char*     buf;
+    size_t    buf_len;
+    uint64_t* offsets;     /* of each object, starting from the given pos */
+    size_t    elems;
+} CosWriteBatch;
+
+/* Serializes indirect objects, using up to the given number of threads.
+ * Offsets are counted from 'pos', e.g. the writer's current position.
+ * Returns NULL on error. */
+DLLEXPORT CosWriteBatch* cos_write_batch(CosIndObj**, size_t, int threads, uint64_t pos);
+DLLEXPORT void cos_write_batch_done(CosWriteBatch*);
+
+#endif
@@ -0,0 +1,222 @@
+/* Concurrent serialization of indirect objects.
+ *
+ * Objects are handed out in chunks of consecutive objects, from a shared
+ * atomic counter, to a small pool of threads. Each thread serializes its
+ * chunks into its own buffer. The chunks are then concatenated, in order,
+ * and object offsets computed as a running sum of their lengths.
+ */
+
+#include "pdf.h"
+#include "pdf/cos.h"
+#include "pdf/cos_write.h"
+#include "pdf/_atomic.h"
+#include "pdf/_thread.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+/* objects claimed by a thread at a time */
+#define COS_WRITE_BATCH_CHUNK 32
+#define COS_WRITE_BATCH_MAX_THREADS 64
+/* free space to try writing an object into, before sizing it */
+#define COS_WRITE_BATCH_MIN_SPACE 4096
+
+typedef struct {
+    char*    buf;
+    size_t   buf_len;
+    size_t   buf_size;
+    int      error;
+} _ThreadBuf;
+
+typedef struct {
+    int      owner;     /* thread that serialized the chunk */
+    size_t   pos;       /* position in the owner's buffer */
+    size_t   len;
+} _Chunk;
+
+typedef struct {
+    CosIndObj** objs;
+    size_t      objs_len;
+    uint32_t    next_chunk;
+    uint32_t    chunks_len;
+    _Chunk*     chunks;
+    uint64_t*   lens;
+    _ThreadBuf* bufs;
+} _BatchCtx;
+
+typedef struct {
+    _BatchCtx* ctx;
+    int        id;
+} _Worker;
+
+static int _reserve(_ThreadBuf* tb, size_t size) {
+    if (tb->buf_len + size > tb->buf_size) {
+        size_t buf_size = tb->buf_size ? tb->buf_size * 2 : 65536;
+        char* buf;
+        while (buf_size < tb->buf_len + size) buf_size *= 2;
+        buf = realloc(tb->buf, buf_size);
+        if (buf == NULL) return 0;
+        tb->buf = buf;
+        tb->buf_size = buf_size;
+    }
+    return 1;
+}
+
+static void _batch_work(_BatchCtx* ctx, int id) {
+    _ThreadBuf* tb = ctx->bufs + id;
+
+    while (!tb->error) {
+        uint32_t c = _atomic_fetch_inc(&ctx->next_chunk);
+        _Chunk* chunk;
+        size_t i, end;
+
+        if (c >= ctx->chunks_len) break;
+        chunk = ctx->chunks + c;
+        i = (size_t) c * COS_WRITE_BATCH_CHUNK;
+        end = i + COS_WRITE_BATCH_CHUNK;
+        if (end > ctx->objs_len) end = ctx->objs_len;
+
+        chunk->owner = id;
+        chunk->pos = tb->buf_len;
+
+        for (; i < end; i++) {
+            CosIndObj* obj = ctx->objs[i];
+            size_t size, n = 0;
+
+            if (obj && obj->type == COS_NODE_IND_OBJ && _reserve(tb, COS_WRITE_BATCH_MIN_SPACE)) {
+                /* most objects fit; only size the ones that don't */
+                n = cos_ind_obj_write(obj, tb->buf + tb->buf_len, tb->buf_size - tb->buf_len);
+                if (n == 0) {
+                    size = cos_node_get_write_size((CosNode*)obj, 0);
+                    if (_reserve(tb, size)) {
+                        n = cos_ind_obj_write(obj, tb->buf + tb->buf_len, size);
+                    }
+                }
+            }
+            if (n == 0) {
+                fprintf(stderr, __FILE__ ":%d unable to write object %" PRIu64 "\n", __LINE__, (uint64_t) i);
+                tb->error = 1;
+                break;
+            }
+            ctx->lens[i] = n;
+            tb->buf_len += n;
+        }
+
+        chunk->len = tb->buf_len - chunk->pos;
+    }
+}
+
+_THREAD_FUNC(_batch_thread) {
+    _Worker* worker = arg;
+    _batch_work(worker->ctx, worker->id);
+    _THREAD_RETURN;
+}
+
+DLLEXPORT CosWriteBatch* cos_write_batch(CosIndObj** objs, size_t objs_len, int threads, uint64_t pos) {
+    CosWriteBatch* self;
+    _BatchCtx ctx;
+    _Worker workers[COS_WRITE_BATCH_MAX_THREADS];
+    _thread_t tids[COS_WRITE_BATCH_MAX_THREADS];
+    int started = 0;
+    int error = 0;
+    size_t buf_len = 0;
+    uint32_t c;
+    int t;
+
+    ctx.objs = objs;
+    ctx.objs_len = objs_len;
+    ctx.next_chunk = 0;
+    ctx.chunks_len = (objs_len + COS_WRITE_BATCH_CHUNK - 1) / COS_WRITE_BATCH_CHUNK;
+
+    if (threads > COS_WRITE_BATCH_MAX_THREADS) threads = COS_WRITE_BATCH_MAX_THREADS;
+    if ((uint32_t) threads > ctx.chunks_len) threads = ctx.chunks_len;
+    if (threads < 1) threads = 1;
+
+    self = malloc(sizeof(CosWriteBatch));
+    if (self == NULL) return NULL;
+    self->elems = objs_len;
+    self->offsets = malloc((objs_len ? objs_len : 1) * sizeof(uint64_t));
+    self->buf = NULL;
+    self->buf_len = 0;
+
+    ctx.lens = self->offsets;
+    ctx.chunks = malloc((ctx.chunks_len ? ctx.chunks_len : 1) * sizeof(_Chunk));
+    ctx.bufs = calloc(threads, sizeof(_ThreadBuf));
+
+    if (self->offsets == NULL || ctx.chunks == NULL || ctx.bufs == NULL) {
+        fprintf(stderr, __FILE__ ":%d out of memory\n", __LINE__);
+        free(ctx.chunks);
+        free(ctx.bufs);
+        cos_write_batch_done(self);
+        return NULL;
+    }
+
+    /* the calling thread also takes part */
+    for (t = 1; t < threads; t++) {
+        workers[t].ctx = &ctx;
+        workers[t].id = t;
+        if (_thread_create(&tids[started], _batch_thread, &workers[t]) != 0) break;
+        started++;
+    }
+    _batch_work(&ctx, 0);
+
+    for (t = 0; t < started; t++) {
+        _thread_join(tids[t]);
+    }
+
+    for (t = 0; t <= started; t++) {
+        error |= ctx.bufs[t].error;
+    }
+
+    if (!error) {
+        for (c = 0; c < ctx.chunks_len; c++) {
+            buf_len += ctx.chunks[c].len;
+        }
+        self->buf = malloc(buf_len ? buf_len : 1);
+        self->buf_len = buf_len;
+        if (self->buf == NULL) {
+            fprintf(stderr, __FILE__ ":%d out of memory\n", __LINE__);
+            error = 1;
+        }
+    }
+
+    if (!error) {
+        buf_len = 0;
+        for (c = 0; c < ctx.chunks_len; c++) {
+            _Chunk* chunk = ctx.chunks + c;
+            size_t i = (size_t) c * COS_WRITE_BATCH_CHUNK;
+            size_t end = i + COS_WRITE_BATCH_CHUNK;
+            if (end > objs_len) end = objs_len;
+
+            memcpy(self->buf + buf_len, ctx.bufs[chunk->owner].buf + chunk->pos, chunk->len);
+            /* lengths -> offsets */
+            for (; i < end; i++) {
+                uint64_t len = self->offsets[i];
+                self->offsets[i] = pos + buf_len;
+                buf_len += len;
+            }
+        }
+    }
+
+    for (t = 0; t < threads; t++) {
+        free(ctx.bufs[t].buf);
+    }
+    free(ctx.bufs);
+    free(ctx.chunks);
+
+    if (error) {
+        cos_write_batch_done(self);
+        self = NULL;
+    }
+
+    return self;
+}
+
+DLLEXPORT void cos_write_batch_done(CosWriteBatch* self) {
+    if (self) {
+        free(self->buf);
+        free(self->offsets);
+        free(self);
+    }
+}
@@ -0,0 +1,319 @@
+/* ASCII85Decode and ASCII85Encode.
+ *
+ * Groups of five characters, '!' to 'u', are base-85 digits of four bytes.
+ * 'z' stands for four zero bytes, and '~>' ends the data; as with other
+ * readers, a '~' alone is enough. A final partial group of n characters is
+ * padded with 'u' and gives n - 1 bytes.
+ *
+ * With AVX2, runs of whole groups are converted six at a time: the digits
+ * are checked against a per-position limit, gathered into 32-bit lanes with
+ * a shuffle, and combined by Horner's rule. A group starting 's' or above
+ * might overflow, so it's left to the scalar loop, as is anything
+ * containing whitespace, 'z' or '~'.
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pdf.h"
+#include "pdf/filt_ascii85.h"
+#include "pdf/_outbuf.h"
+#include "pdf/_simd.h"
+
+#define PDF_A85_LINE 75
+
+struct PdfFiltASCII85 {
+  _OutBuf  out;         /* output from the last call */
+  uint64_t tuple;       /* the group so far */
+  unsigned count;       /* characters, or bytes, in the group so far */
+  unsigned column;      /* encoding: characters on the current line */
+  uint8_t  encode;
+  uint8_t  eod;
+};
+
+static int _is_space(uint8_t c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f' || c == 0;
+}
+
+static void _store_be(uint8_t *out, uint32_t v) {
+  out[0] = v >> 24;
+  out[1] = v >> 16;
+  out[2] = v >> 8;
+  out[3] = v;
+}
+
+#ifdef PDF_AVX2
+
+/* Converts whole groups, 30 characters at a time, stopping at the first
+ * block with anything else. Returns the characters consumed, writing 4/5
+ * as many bytes, plus up to 4 bytes of scratch */
+PDF_TARGET_AVX2
+static size_t _decode_avx2(const uint8_t *in, size_t len, uint8_t *out) {
+  /* 15 characters per 128-bit lane, as three groups */
+#define A85_LIMIT 81, 84, 84, 84, 84, 81, 84, 84, 84, 84, 81, 84, 84, 84, 84, -1
+#define A85_DIGIT(k) k, -1, -1, -1, 5 + k, -1, -1, -1, 10 + k, -1, -1, -1, -1, -1, -1, -1
+  const __m256i limit = _mm256_setr_epi8(A85_LIMIT, A85_LIMIT);
+  const __m256i digit0 = _mm256_setr_epi8(A85_DIGIT(0), A85_DIGIT(0));
+  const __m256i digit1 = _mm256_setr_epi8(A85_DIGIT(1), A85_DIGIT(1));
+  const __m256i digit2 = _mm256_setr_epi8(A85_DIGIT(2), A85_DIGIT(2));
+  const __m256i digit3 = _mm256_setr_epi8(A85_DIGIT(3), A85_DIGIT(3));
+  const __m256i digit4 = _mm256_setr_epi8(A85_DIGIT(4), A85_DIGIT(4));
+  /* big-endian bytes of the three 32-bit values */
+  const __m256i bswap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, -1, -1, -1, -1,
+                                         3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, -1, -1, -1, -1);
+  const __m256i base = _mm256_set1_epi32(85);
+#undef A85_LIMIT
+#undef A85_DIGIT
+  size_t i;
+
+  for (i = 0; i + 32 <= len; i += 30) {
+    __m256i v = _mm256_inserti128_si256(
+      _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*) (in + i))),
+      _mm_loadu_si128((const __m128i*) (in + i + 15)), 1);
+    __m256i t;
+
+    v = _mm256_sub_epi8(v, _mm256_set1_epi8('!'));
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(v, limit), limit)) != -1) break;
+
+    t = _mm256_shuffle_epi8(v, digit0);
+    t = _mm256_add_epi32(_mm256_mullo_epi32(t, base), _mm256_shuffle_epi8(v, digit1));
+    t = _mm256_add_epi32(_mm256_mullo_epi32(t, base), _mm256_shuffle_epi8(v, digit2));
+    t = _mm256_add_epi32(_mm256_mullo_epi32(t, base), _mm256_shuffle_epi8(v, digit3));
+    t = _mm256_add_epi32(_mm256_mullo_epi32(t, base), _mm256_shuffle_epi8(v, digit4));
+    t = _mm256_shuffle_epi8(t, bswap);
+
+    _mm_storeu_si128((__m128i*) out, _mm256_castsi256_si128(t));
+    _mm_storeu_si128((__m128i*) (out + 12), _mm256_extracti128_si256(t, 1));
+    out += 24;
+  }
+  return i;
+}
+
+#endif
+
+/* the last, partial, group; padded with 'u' */
+static int _decode_partial(PdfFiltASCII85 *self, uint8_t **out) {
+  unsigned n = self->count;
+  uint64_t tuple = self->tuple;
+  uint8_t bytes[4];
+
+  if (n == 0) return 0;
+  if (n == 1) {
+    fprintf(stderr, "%s: ASCII85 stream ends with a single character group\n", __FILE__);
+    return -1;
+  }
+  for (; n < 5; n++) tuple = tuple * 85 + 84;
+  if (tuple > UINT32_MAX) {
+    fprintf(stderr, "%s: ASCII85 group overflow\n", __FILE__);
+    return -1;
+  }
+  _store_be(bytes, (uint32_t) tuple);
+  memcpy(*out, bytes, self->count - 1);
+  *out += self->count - 1;
+  self->count = 0;
+  self->tuple = 0;
+  return 0;
+}
+
+static int _decode(PdfFiltASCII85 *self, uint8_t *in, size_t in_len) {
+  _OutBuf *ob = &self->out;
+  uint8_t *end = in + in_len;
+  uint8_t *out;
+  int rc = 0;
+#ifdef PDF_AVX2
+  int avx2 = _have_avx2();
+#endif
+
+  if (self->eod) return 0;
+  /* 'z' gives four bytes; also allow for scratch */
+  if (_reserve(ob, in_len * 4 + 8)) return -1;
+  out = ob->buf + ob->len;
+
+  while (in < end) {
+    uint8_t c;
+#ifdef PDF_AVX2
+    if (avx2 && self->count == 0) {
+      size_t n = _decode_avx2(in, end - in, out);
+      in += n;
+      out += n / 5 * 4;
+      if (in == end) break;
+    }
+#endif
+    c = *in++;
+    if (c >= '!' && c <= 'u') {
+      self->tuple = self->tuple * 85 + (c - '!');
+      if (++self->count == 5) {
+        if (self->tuple > UINT32_MAX) {
+          fprintf(stderr, "%s: ASCII85 group overflow\n", __FILE__);
+          rc = -1;
+          break;
+        }
+        _store_be(out, (uint32_t) self->tuple);
+        out += 4;
+        self->count = 0;
+        self->tuple = 0;
+      }
+    }
+    else if (c == 'z' && self->count == 0) {
+      memset(out, 0, 4);
+      out += 4;
+    }
+    else if (c == '~') {
+      self->eod = 1;
+      break;
+    }
+    else if (!_is_space(c)) {
+      fprintf(stderr, "%s: illegal character in ASCII85 stream: 0x%02x\n", __FILE__, c);
+      rc = -1;
+      break;
+    }
+  }
+
+  if (self->eod && !rc) rc = _decode_partial(self, &out);
+  ob->len = out - ob->buf;
+  return rc;
+}
+
+/* writes a group of n + 1 characters, for n bytes, or 'z' */
+static void _encode_group(PdfFiltASCII85 *self, uint32_t tuple, unsigned n, _OutBuf *ob) {
+  uint8_t *out = ob->buf + ob->len;
+  if (tuple == 0 && n == 4) {
+    *out = 'z';
+    ob->len++;
+    self->column++;
+  }
+  else {
+    uint8_t digits[5];
+    int i;
+    for (i = 4; i >= 0; i--) {
+      digits[i] = '!' + tuple % 85;
+      tuple /= 85;
+    }
+    memcpy(out, digits, n + 1);
+    ob->len += n + 1;
+    self->column += n + 1;
+  }
+  if (self->column >= PDF_A85_LINE) {
+    ob->buf[ob->len++] = '\n';
+    self->column = 0;
+  }
+}
+
+static int _encode(PdfFiltASCII85 *self, uint8_t *in, size_t in_len) {
+  _OutBuf *ob = &self->out;
+  uint32_t tuple = (uint32_t) self->tuple;
+  size_t i;
+
+  /* 5/4 as many characters, and line breaks */
+  if (_reserve(ob, in_len + in_len / 2 + 8)) return -1;
+
+  for (i = 0; i < in_len; i++) {
+    tuple = (tuple << 8) | in[i];
+    if (++self->count == 4) {
+      _encode_group(self, tuple, 4, ob);
+      tuple = 0;
+      self->count = 0;
+    }
+  }
+  self->tuple = tuple;
+  return 0;
+}
+
+static int _finish(PdfFiltASCII85 *self) {
+  if (self->eod) return 0;
+  if (self->encode) {
+    _OutBuf *ob = &self->out;
+    if (_reserve(ob, 8)) return -1;
+    if (self->count) {
+      /* pad with zeros, and write just enough digits */
+      _encode_group(self, (uint32_t) self->tuple << (8 * (4 - self->count)), self->count, ob);
+    }
+    ob->buf[ob->len++] = '~';
+    ob->buf[ob->len++] = '>';
+  }
+  else {
+    /* no closing '~>'; keep what we have */
+    uint8_t *out;
+    if (_reserve(&self->out, 4)) return -1;
+    out = self->out.buf + self->out.len;
+    if (_decode_partial(self, &out)) return -1;
+    self->out.len = out - self->out.buf;
+  }
+  self->eod = 1;
+  return 0;
+}
+
+DLLEXPORT PdfFiltASCII85* pdf_filt_ascii85_new(int encode) {
+  PdfFiltASCII85 *self = calloc(1, sizeof(PdfFiltASCII85));
+  if (self == NULL) return NULL;
+  self->encode = encode ? 1 : 0;
+  return self;
+}
+
+DLLEXPORT int
+pdf_filt_ascii85_put(PdfFiltASCII85 *self,
+                     uint8_t *in,
+                     size_t in_len,
+                     uint8_t **out,
+                     size_t *out_len
+                     ) {
+  int rc;
+  if (self->encode && self->eod) return -1;
+  self->out.len = 0;
+  rc = self->encode ? _encode(self, in, in_len) : _decode(self, in, in_len);
+  *out = self->out.buf;
+  *out_len = rc ? 0 : self->out.len;
+  return rc;
+}
+
+DLLEXPORT int pdf_filt_ascii85_finish(PdfFiltASCII85 *self, uint8_t **out, size_t *out_len) {
+  int rc;
+  self->out.len = 0;
+  rc = _finish(self);
+  *out = self->out.buf;
+  *out_len = rc ? 0 : self->out.len;
+  return rc;
+}
+
+DLLEXPORT void pdf_filt_ascii85_done(PdfFiltASCII85 *self) {
+  if (self) {
+    free(self->out.buf);
+    free(self);
+  }
+}
+
+/* one-shot: the whole input, then hand over the output buffer */
+static int _run(uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len, int encode) {
+  PdfFiltASCII85 *self = pdf_filt_ascii85_new(encode);
+  int rc = -1;
+
+  *out = NULL;
+  *out_len = 0;
+
+  if (self == NULL) return -1;
+
+  if ((encode ? _encode(self, in, in_len) : _decode(self, in, in_len)) == 0
+      && _finish(self) == 0) {
+    *out = self->out.buf;
+    *out_len = self->out.len;
+    self->out.buf = NULL;
+    rc = 0;
+  }
+
+  pdf_filt_ascii85_done(self);
+  return rc;
+}
+
+DLLEXPORT int pdf_filt_ascii85_decode(uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len) {
+  return _run(in, in_len, out, out_len, 0);
+}
+
+DLLEXPORT int pdf_filt_ascii85_encode(uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len) {
+  return _run(in, in_len, out, out_len, 1);
+}
+
+DLLEXPORT void pdf_filt_ascii85_free(uint8_t *buf) {
+  free(buf);
+}
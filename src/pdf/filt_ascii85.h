@@ -0,0 +1,30 @@
+#ifndef PDF_FILT_ASCII85_H_
+#define PDF_FILT_ASCII85_H_
+
+/* A streaming ASCII85 decoder, or encoder; opaque */
+typedef struct PdfFiltASCII85 PdfFiltASCII85;
+
+DLLEXPORT PdfFiltASCII85* pdf_filt_ascii85_new(int encode);
+
+// Consumes in_len bytes. Sets *out to any output, which remains owned by
+// the decoder and is valid until the next call. Returns 0, or -1 on error
+DLLEXPORT int
+pdf_filt_ascii85_put(PdfFiltASCII85*,
+                     uint8_t *in,
+                     size_t in_len,
+                     uint8_t **out,
+                     size_t *out_len
+                     );
+
+// Ends the stream. An encoder writes any final partial group and '~>'
+DLLEXPORT int pdf_filt_ascii85_finish(PdfFiltASCII85*, uint8_t **out, size_t *out_len);
+
+DLLEXPORT void pdf_filt_ascii85_done(PdfFiltASCII85*);
+
+// Returns 0 and sets *out, to be freed by pdf_filt_ascii85_free(), or -1
+DLLEXPORT int pdf_filt_ascii85_decode(uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len);
+DLLEXPORT int pdf_filt_ascii85_encode(uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len);
+
+DLLEXPORT void pdf_filt_ascii85_free(uint8_t *);
+
+#endif
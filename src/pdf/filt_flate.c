@@ -0,0 +1,444 @@
+/* FlateDecode and FlateEncode, fused with the predictors.
+ *
+ * Rather than inflating a whole image, then decoding predictors in a
+ * second pass, each row is decoded as soon as it has been inflated. Only
+ * the current input row and the previous output row are needed. Likewise,
+ * rows are predicted then deflated.
+ *
+ * The streaming context, PdfFiltFlate, is fed input in chunks of any size,
+ * with the predictor chained after inflate, or before deflate.
+ *
+ * Requires zlib. Built without PDF_ZLIB, these functions just return -1,
+ * or NULL.
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pdf.h"
+#include "pdf/filt_predict.h"
+#include "pdf/filt_predict_tiff.h"
+#include "pdf/filt_predict_png.h"
+#include "pdf/filt_flate.h"
+#include "pdf/_outbuf.h"
+
+#ifdef PDF_ZLIB
+#include <zlib.h>
+
+#define PDF_FLATE_CHUNK 16384
+
+/* row sizes, in bytes, and PNG bytes per pixel */
+static size_t _row_size(uint8_t colors, uint8_t bpc, uint16_t columns) {
+  return ((size_t) colors * bpc * columns + 7) / 8;
+}
+
+static int _is_png(uint8_t predictor) {
+  return predictor >= PDF_FILTER_PNG_NONE_ALL_ROWS && predictor <= PDF_FILTER_PNG_OPTIMUM;
+}
+
+static int _check_predictor(uint8_t predictor) {
+  if (predictor == PDF_FILTER_NO_PREDICTION
+      || predictor == PDF_FILTER_TIFF_PREDICTOR
+      || _is_png(predictor)) {
+    return 0;
+  }
+  fprintf(stderr, "%s: unknown predictor-type: %d\n", __FILE__, predictor);
+  return -1;
+}
+
+DLLEXPORT int pdf_filt_flate_available(void) {
+  return 1;
+}
+
+DLLEXPORT int
+pdf_filt_flate_decode(uint8_t *in,
+                      size_t in_len,
+                      uint8_t **out,
+                      size_t *out_len,
+                      uint8_t predictor,
+                      uint8_t colors,
+                      uint8_t bpc,
+                      uint16_t columns
+                      ) {
+  z_stream zs;
+  _OutBuf ob = { NULL, 0, 0 };
+  int png = _is_png(predictor);
+  int predicted = predictor != PDF_FILTER_NO_PREDICTION;
+  size_t row_size = _row_size(colors, bpc, columns);
+  /* the current row, before decoding predictors */
+  size_t row_in_size = row_size + png;
+  uint8_t *row = NULL;
+  size_t filled = 0;
+  int rc = 0;
+
+  *out = NULL;
+  *out_len = 0;
+
+  if (_check_predictor(predictor)) return -1;
+  if (predicted && row_size == 0) return -1;
+
+  memset(&zs, 0, sizeof(zs));
+  if (inflateInit(&zs) != Z_OK) return -1;
+  zs.next_in = in;
+  zs.avail_in = 0;
+
+  if (predicted) row = malloc(row_in_size);
+
+  for (;;) {
+    int ret;
+
+    if (zs.avail_in == 0 && in_len) {
+      /* avail_in is only 32 bits */
+      zs.avail_in = in_len > UINT32_MAX ? UINT32_MAX : in_len;
+      in_len -= zs.avail_in;
+    }
+
+    if (predicted) {
+      zs.next_out = row + filled;
+      zs.avail_out = row_in_size - filled;
+    }
+    else {
+      if (_reserve(&ob, PDF_FLATE_CHUNK)) { rc = -1; break; }
+      zs.next_out = ob.buf + ob.len;
+      zs.avail_out = PDF_FLATE_CHUNK;
+    }
+
+    ret = inflate(&zs, Z_NO_FLUSH);
+
+    if (predicted) {
+      filled = row_in_size - zs.avail_out;
+      if (filled == row_in_size) {
+        uint8_t *prev;
+        if (_reserve(&ob, row_size)) { rc = -1; break; }
+        prev = ob.len ? ob.buf + ob.len - row_size : NULL;
+        if (png) {
+          if (pdf_filt_predict_png_decode_row(row[0], row + 1, ob.buf + ob.len, prev, row_size, pdf_filt_predict_png_bpp(colors, bpc))) {
+            rc = -1;
+            break;
+          }
+        }
+        else if (pdf_filt_predict_tiff_decode_row(row, ob.buf + ob.len, colors, bpc, columns)) {
+          rc = -1;
+          break;
+        }
+        ob.len += row_size;
+        filled = 0;
+      }
+    }
+    else {
+      ob.len += PDF_FLATE_CHUNK - zs.avail_out;
+    }
+
+    if (ret == Z_STREAM_END) break;
+    if (ret == Z_BUF_ERROR && zs.avail_in == 0 && in_len == 0) {
+      /* truncated; keep what we have */
+      break;
+    }
+    if (ret != Z_OK && ret != Z_BUF_ERROR) {
+      fprintf(stderr, "%s: inflate failed: %s\n", __FILE__, zs.msg ? zs.msg : "error");
+      rc = -1;
+      break;
+    }
+  }
+
+  inflateEnd(&zs);
+  free(row);
+
+  if (rc) {
+    free(ob.buf);
+  }
+  else {
+    *out = ob.buf;
+    *out_len = ob.len;
+  }
+  return rc;
+}
+
+static int _deflate(z_stream *zs, _OutBuf *ob, uint8_t *in, size_t in_len, int flush) {
+  zs->next_in = in;
+  zs->avail_in = in_len;
+  do {
+    int ret;
+    if (_reserve(ob, PDF_FLATE_CHUNK)) return -1;
+    zs->next_out = ob->buf + ob->len;
+    zs->avail_out = PDF_FLATE_CHUNK;
+    ret = deflate(zs, flush);
+    if (ret == Z_STREAM_ERROR) return -1;
+    ob->len += PDF_FLATE_CHUNK - zs->avail_out;
+    if (ret == Z_STREAM_END) break;
+  } while (zs->avail_out == 0 || (flush == Z_FINISH));
+  return 0;
+}
+
+DLLEXPORT int
+pdf_filt_flate_encode(uint8_t *in,
+                      size_t in_len,
+                      uint8_t **out,
+                      size_t *out_len,
+                      uint8_t predictor,
+                      uint8_t colors,
+                      uint8_t bpc,
+                      uint16_t columns,
+                      int level
+                      ) {
+  z_stream zs;
+  _OutBuf ob = { NULL, 0, 0 };
+  int png = _is_png(predictor);
+  size_t row_size = _row_size(colors, bpc, columns);
+  int rc = 0;
+
+  *out = NULL;
+  *out_len = 0;
+
+  if (_check_predictor(predictor)) return -1;
+
+  memset(&zs, 0, sizeof(zs));
+  if (deflateInit(&zs, level) != Z_OK) return -1;
+
+  if (predictor == PDF_FILTER_NO_PREDICTION) {
+    while (in_len && !rc) {
+      size_t n = in_len > UINT32_MAX ? UINT32_MAX : in_len;
+      rc = _deflate(&zs, &ob, in, n, Z_NO_FLUSH);
+      in += n;
+      in_len -= n;
+    }
+  }
+  else if (row_size == 0) {
+    rc = -1;
+  }
+  else {
+    /* the current row, after encoding predictors */
+    uint8_t *row = malloc(row_size + png);
+    uint8_t *prev = NULL;
+    int optimum = predictor == PDF_FILTER_PNG_OPTIMUM;
+    uint8_t tag = predictor - PDF_FILTER_PNG_NONE_ALL_ROWS;
+
+    for (; in_len >= row_size && !rc; in_len -= row_size) {
+      if (png) {
+        if (optimum) {
+          tag = pdf_filt_predict_png_select_row(in, prev, row_size, pdf_filt_predict_png_bpp(colors, bpc));
+        }
+        row[0] = tag;
+        pdf_filt_predict_png_encode_row(tag, in, row + 1, prev, row_size, pdf_filt_predict_png_bpp(colors, bpc));
+      }
+      else if (pdf_filt_predict_tiff_encode_row(in, row, colors, bpc, columns)) {
+        rc = -1;
+        break;
+      }
+      rc = _deflate(&zs, &ob, row, row_size + png, Z_NO_FLUSH);
+      prev = in;
+      in += row_size;
+    }
+    free(row);
+  }
+
+  if (!rc) rc = _deflate(&zs, &ob, NULL, 0, Z_FINISH);
+
+  deflateEnd(&zs);
+
+  if (rc) {
+    free(ob.buf);
+  }
+  else {
+    *out = ob.buf;
+    *out_len = ob.len;
+  }
+  return rc;
+}
+
+
+struct PdfFiltFlate {
+  z_stream zs;
+  PdfFiltPredictor *predictor;  /* NULL, for no prediction */
+  _OutBuf  out;                 /* output from the last call */
+  _OutBuf  rows;                /* between the flate and predictor stages */
+  uint8_t  encode;
+  uint8_t  eod;
+};
+
+static int _inflate(PdfFiltFlate *self, uint8_t *in, size_t in_len, _OutBuf *ob) {
+  z_stream *zs = &self->zs;
+
+  while (in_len && !self->eod) {
+    size_t n = in_len > UINT32_MAX ? UINT32_MAX : in_len;
+    zs->next_in = in;
+    zs->avail_in = n;
+    in += n;
+    in_len -= n;
+    do {
+      int ret;
+      if (_reserve(ob, PDF_FLATE_CHUNK)) return -1;
+      zs->next_out = ob->buf + ob->len;
+      zs->avail_out = PDF_FLATE_CHUNK;
+      ret = inflate(zs, Z_NO_FLUSH);
+      ob->len += PDF_FLATE_CHUNK - zs->avail_out;
+      if (ret == Z_STREAM_END) {
+        /* ignore anything trailing */
+        self->eod = 1;
+        break;
+      }
+      if (ret != Z_OK && ret != Z_BUF_ERROR) {
+        fprintf(stderr, "%s: inflate failed: %s\n", __FILE__, zs->msg ? zs->msg : "error");
+        return -1;
+      }
+    } while (zs->avail_in || zs->avail_out == 0);
+  }
+  return 0;
+}
+
+DLLEXPORT PdfFiltFlate*
+pdf_filt_flate_new(int encode,
+                   uint8_t predictor,
+                   uint8_t colors,
+                   uint8_t bpc,
+                   uint16_t columns,
+                   int level
+                   ) {
+  PdfFiltFlate *self = calloc(1, sizeof(PdfFiltFlate));
+  int ret;
+
+  if (self == NULL) return NULL;
+
+  if (predictor != PDF_FILTER_NO_PREDICTION) {
+    self->predictor = pdf_filt_predictor_new(predictor, colors, bpc, columns, encode);
+    if (self->predictor == NULL) {
+      free(self);
+      return NULL;
+    }
+  }
+
+  self->encode = encode ? 1 : 0;
+  ret = encode ? deflateInit(&self->zs, level) : inflateInit(&self->zs);
+  if (ret != Z_OK) {
+    pdf_filt_predictor_done(self->predictor);
+    free(self);
+    return NULL;
+  }
+
+  return self;
+}
+
+/* as pdf_filt_flate_put(), appending to self->out */
+static int _put(PdfFiltFlate *self, uint8_t *in, size_t in_len) {
+  if (self->predictor == NULL) {
+    if (!self->encode) return _inflate(self, in, in_len, &self->out);
+  }
+  else if (self->encode) {
+    size_t n = pdf_filt_predictor_out_size(self->predictor, in_len);
+    self->rows.len = 0;
+    if (in_len == 0) return 0;
+    if (_reserve(&self->rows, n)
+        || pdf_filt_predictor_put(self->predictor, in, in_len, self->rows.buf, &self->rows.len)) {
+      return -1;
+    }
+    in = self->rows.buf;
+    in_len = self->rows.len;
+  }
+  else {
+    size_t n, len;
+    self->rows.len = 0;
+    if (_inflate(self, in, in_len, &self->rows)) return -1;
+    if (self->rows.len == 0) return 0;
+    n = pdf_filt_predictor_out_size(self->predictor, self->rows.len);
+    if (_reserve(&self->out, n)
+        || pdf_filt_predictor_put(self->predictor, self->rows.buf, self->rows.len, self->out.buf + self->out.len, &len)) {
+      return -1;
+    }
+    self->out.len += len;
+    return 0;
+  }
+
+  /* encoding */
+  while (in_len) {
+    size_t n = in_len > UINT32_MAX ? UINT32_MAX : in_len;
+    if (_deflate(&self->zs, &self->out, in, n, Z_NO_FLUSH)) return -1;
+    in += n;
+    in_len -= n;
+  }
+  return 0;
+}
+
+DLLEXPORT int
+pdf_filt_flate_put(PdfFiltFlate *self,
+                   uint8_t *in,
+                   size_t in_len,
+                   uint8_t **out,
+                   size_t *out_len
+                   ) {
+  int rc;
+  if (self->encode && self->eod) return -1;
+  self->out.len = 0;
+  rc = _put(self, in, in_len);
+  *out = self->out.buf;
+  *out_len = rc ? 0 : self->out.len;
+  return rc;
+}
+
+DLLEXPORT int pdf_filt_flate_finish(PdfFiltFlate *self, uint8_t **out, size_t *out_len) {
+  int rc = 0;
+  self->out.len = 0;
+  if (self->encode && !self->eod) {
+    rc = _deflate(&self->zs, &self->out, NULL, 0, Z_FINISH);
+  }
+  /* decoding: if truncated, keep what we have */
+  self->eod = 1;
+  *out = self->out.buf;
+  *out_len = rc ? 0 : self->out.len;
+  return rc;
+}
+
+DLLEXPORT void pdf_filt_flate_done(PdfFiltFlate *self) {
+  if (self) {
+    if (self->encode) deflateEnd(&self->zs); else inflateEnd(&self->zs);
+    pdf_filt_predictor_done(self->predictor);
+    free(self->out.buf);
+    free(self->rows.buf);
+    free(self);
+  }
+}
+
+#else
+
+DLLEXPORT int pdf_filt_flate_available(void) {
+  return 0;
+}
+
+DLLEXPORT int
+pdf_filt_flate_decode(uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len,
+                      uint8_t predictor, uint8_t colors, uint8_t bpc, uint16_t columns) {
+  fprintf(stderr, "%s: built without zlib\n", __FILE__);
+  return -1;
+}
+
+DLLEXPORT int
+pdf_filt_flate_encode(uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len,
+                      uint8_t predictor, uint8_t colors, uint8_t bpc, uint16_t columns, int level) {
+  fprintf(stderr, "%s: built without zlib\n", __FILE__);
+  return -1;
+}
+
+DLLEXPORT PdfFiltFlate*
+pdf_filt_flate_new(int encode, uint8_t predictor, uint8_t colors, uint8_t bpc, uint16_t columns, int level) {
+  fprintf(stderr, "%s: built without zlib\n", __FILE__);
+  return NULL;
+}
+
+DLLEXPORT int
+pdf_filt_flate_put(PdfFiltFlate *self, uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len) {
+  return -1;
+}
+
+DLLEXPORT int pdf_filt_flate_finish(PdfFiltFlate *self, uint8_t **out, size_t *out_len) {
+  return -1;
+}
+
+DLLEXPORT void pdf_filt_flate_done(PdfFiltFlate *self) {
+}
+
+#endif
+
+DLLEXPORT void pdf_filt_flate_free(uint8_t *buf) {
+  free(buf);
+}
@@ -0,0 +1,66 @@
+#ifndef PDF_FILT_FLATE_H_
+#define PDF_FILT_FLATE_H_
+
+// Returns 1 if built with zlib, 0 otherwise
+DLLEXPORT int pdf_filt_flate_available(void);
+
+// Inflate, then decode None, TIFF or PNG predictors, a row at a time.
+// Returns 0 and sets *out, to be freed by pdf_filt_flate_free(), or -1
+DLLEXPORT int
+pdf_filt_flate_decode(uint8_t *in,
+                      size_t in_len,
+                      uint8_t **out,
+                      size_t *out_len,
+                      uint8_t predictor,
+                      uint8_t colors,
+                      uint8_t bpc,
+                      uint16_t columns
+                      );
+
+// Encode None, TIFF or PNG predictors, a row at a time, then deflate.
+// Returns 0 and sets *out, to be freed by pdf_filt_flate_free(), or -1
+DLLEXPORT int
+pdf_filt_flate_encode(uint8_t *in,
+                      size_t in_len,
+                      uint8_t **out,
+                      size_t *out_len,
+                      uint8_t predictor,
+                      uint8_t colors,
+                      uint8_t bpc,
+                      uint16_t columns,
+                      int level
+                      );
+
+DLLEXPORT void pdf_filt_flate_free(uint8_t *);
+
+/* A streaming inflater, or deflater, optionally chained with a streaming
+ * predictor; opaque */
+typedef struct PdfFiltFlate PdfFiltFlate;
+
+// Returns a new decoder, or encoder, or NULL for an unknown predictor, or
+// without zlib. level is only used when encoding
+DLLEXPORT PdfFiltFlate*
+pdf_filt_flate_new(int encode,
+                   uint8_t predictor,
+                   uint8_t colors,
+                   uint8_t bpc,
+                   uint16_t columns,
+                   int level
+                   );
+
+// Consumes in_len bytes. Sets *out to any output, which remains owned by
+// the decoder and is valid until the next call. Returns 0, or -1 on error
+DLLEXPORT int
+pdf_filt_flate_put(PdfFiltFlate*,
+                   uint8_t *in,
+                   size_t in_len,
+                   uint8_t **out,
+                   size_t *out_len
+                   );
+
+// Ends the stream. An encoder flushes the deflated data
+DLLEXPORT int pdf_filt_flate_finish(PdfFiltFlate*, uint8_t **out, size_t *out_len);
+
+DLLEXPORT void pdf_filt_flate_done(PdfFiltFlate*);
+
+#endif
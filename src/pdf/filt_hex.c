@@ -0,0 +1,289 @@
+/* ASCIIHexDecode and ASCIIHexEncode.
+ *
+ * Decoding looks up the nibbles of 16 characters at a time with SSE2. A
+ * block of hex digits is packed directly; whitespace within a block is
+ * skipped using the mask of digit positions. Anything else, including the
+ * closing '>', is left to the scalar loop.
+ *
+ * Encoding writes lower case digits, in lines of PDF_HEX_LINE characters.
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pdf.h"
+#include "pdf/filt_hex.h"
+#include "pdf/_outbuf.h"
+#include "pdf/_simd.h"
+
+#define PDF_HEX_LINE 64
+
+struct PdfFiltHex {
+  _OutBuf  out;         /* output from the last call */
+  int      nibble;      /* decoding: a pending high nibble, or -1 */
+  unsigned column;      /* encoding: characters on the current line */
+  uint8_t  encode;
+  uint8_t  eod;
+};
+
+static int _digit(uint8_t c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  c |= 0x20;
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return -1;
+}
+
+static int _is_space(uint8_t c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f' || c == 0;
+}
+
+static uint8_t _hex_char(uint8_t n) {
+  return n < 10 ? '0' + n : 'a' + (n - 10);
+}
+
+#ifdef PDF_SSE2
+
+/* Decodes whole blocks of 16 hex digits and whitespace, stopping at the
+ * first block with anything else. Returns the characters consumed */
+static size_t _decode_sse2(const uint8_t *in, size_t len, uint8_t **out, int *nibble) {
+  const __m128i nine = _mm_set1_epi8(9);
+  const __m128i five = _mm_set1_epi8(5);
+  uint8_t *o = *out;
+  size_t i;
+
+  for (i = 0; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i*) (in + i));
+    __m128i d = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+    __m128i a = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(d, nine), d);
+    __m128i is_alpha = _mm_cmpeq_epi8(_mm_min_epu8(a, five), a);
+    __m128i space = _mm_or_si128(
+      _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))),
+      _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(v, _mm_setzero_si128())));
+    __m128i value;
+    int hex_mask;
+
+    space = _mm_or_si128(space,
+      _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\t')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\f'))));
+    hex_mask = _mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha));
+    if ((hex_mask | _mm_movemask_epi8(space)) != 0xFFFF) break;
+
+    value = _mm_or_si128(_mm_and_si128(is_digit, d),
+                         _mm_and_si128(is_alpha, _mm_add_epi8(a, _mm_set1_epi8(10))));
+
+    if (hex_mask == 0xFFFF && *nibble < 0) {
+      /* pairs of digits, as 16-bit lanes: high nibble, then low nibble */
+      __m128i bytes = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(value, _mm_set1_epi16(0x00FF)), 4),
+                                   _mm_srli_epi16(value, 8));
+      _mm_storel_epi64((__m128i*) o, _mm_packus_epi16(bytes, bytes));
+      o += 8;
+    }
+    else {
+      uint8_t values[16];
+      _mm_storeu_si128((__m128i*) values, value);
+      while (hex_mask) {
+        int j = _ctz(hex_mask);
+        hex_mask &= hex_mask - 1;
+        if (*nibble < 0) {
+          *nibble = values[j];
+        }
+        else {
+          *o++ = (*nibble << 4) | values[j];
+          *nibble = -1;
+        }
+      }
+    }
+  }
+
+  *out = o;
+  return i;
+}
+
+#endif
+
+static void _encode_digits(const uint8_t *in, size_t len, uint8_t *out) {
+  size_t i = 0;
+#ifdef PDF_SSE2
+  const __m128i low = _mm_set1_epi8(0x0F);
+  const __m128i nine = _mm_set1_epi8(9);
+
+  for (; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i*) (in + i));
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), low);
+    __m128i lo = _mm_and_si128(v, low);
+    /* '0' + n, or 'a' - 10 + n */
+    hi = _mm_add_epi8(_mm_add_epi8(hi, _mm_set1_epi8('0')),
+                      _mm_and_si128(_mm_cmpgt_epi8(hi, nine), _mm_set1_epi8('a' - 10 - '0')));
+    lo = _mm_add_epi8(_mm_add_epi8(lo, _mm_set1_epi8('0')),
+                      _mm_and_si128(_mm_cmpgt_epi8(lo, nine), _mm_set1_epi8('a' - 10 - '0')));
+    _mm_storeu_si128((__m128i*) (out + 2 * i), _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128((__m128i*) (out + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+  }
+#endif
+  for (; i < len; i++) {
+    out[2 * i] = _hex_char(in[i] >> 4);
+    out[2 * i + 1] = _hex_char(in[i] & 0x0F);
+  }
+}
+
+static int _decode(PdfFiltHex *self, uint8_t *in, size_t in_len) {
+  _OutBuf *ob = &self->out;
+  uint8_t *end = in + in_len;
+  uint8_t *out;
+  int rc = 0;
+
+  if (self->eod) return 0;
+  if (_reserve(ob, in_len / 2 + 8)) return -1;
+  out = ob->buf + ob->len;
+
+  while (in < end) {
+    uint8_t c;
+    int d;
+#ifdef PDF_SSE2
+    in += _decode_sse2(in, end - in, &out, &self->nibble);
+    if (in == end) break;
+#endif
+    c = *in++;
+    d = _digit(c);
+    if (d >= 0) {
+      if (self->nibble < 0) {
+        self->nibble = d;
+      }
+      else {
+        *out++ = (self->nibble << 4) | d;
+        self->nibble = -1;
+      }
+    }
+    else if (c == '>') {
+      self->eod = 1;
+      break;
+    }
+    else if (!_is_space(c)) {
+      fprintf(stderr, "%s: illegal character in hex stream: 0x%02x\n", __FILE__, c);
+      rc = -1;
+      break;
+    }
+  }
+
+  if (self->eod && self->nibble >= 0) {
+    /* an odd number of digits; the last is followed by 0 */
+    *out++ = self->nibble << 4;
+    self->nibble = -1;
+  }
+  ob->len = out - ob->buf;
+  return rc;
+}
+
+static int _encode(PdfFiltHex *self, uint8_t *in, size_t in_len) {
+  _OutBuf *ob = &self->out;
+
+  if (_reserve(ob, in_len * 2 + in_len / (PDF_HEX_LINE / 2) + 2)) return -1;
+
+  while (in_len) {
+    size_t n = (PDF_HEX_LINE - self->column) / 2;
+    if (n > in_len) n = in_len;
+    _encode_digits(in, n, ob->buf + ob->len);
+    ob->len += 2 * n;
+    self->column += 2 * n;
+    in += n;
+    in_len -= n;
+    if (self->column >= PDF_HEX_LINE) {
+      ob->buf[ob->len++] = '\n';
+      self->column = 0;
+    }
+  }
+  return 0;
+}
+
+static int _finish(PdfFiltHex *self) {
+  if (self->encode) {
+    if (!self->eod) {
+      if (_reserve(&self->out, 1)) return -1;
+      self->out.buf[self->out.len++] = '>';
+    }
+  }
+  else if (!self->eod && self->nibble >= 0) {
+    /* no closing '>'; keep what we have */
+    if (_reserve(&self->out, 1)) return -1;
+    self->out.buf[self->out.len++] = self->nibble << 4;
+    self->nibble = -1;
+  }
+  self->eod = 1;
+  return 0;
+}
+
+DLLEXPORT PdfFiltHex* pdf_filt_hex_new(int encode) {
+  PdfFiltHex *self = calloc(1, sizeof(PdfFiltHex));
+  if (self == NULL) return NULL;
+  self->nibble = -1;
+  self->encode = encode ? 1 : 0;
+  return self;
+}
+
+DLLEXPORT int
+pdf_filt_hex_put(PdfFiltHex *self,
+                 uint8_t *in,
+                 size_t in_len,
+                 uint8_t **out,
+                 size_t *out_len
+                 ) {
+  int rc;
+  if (self->encode && self->eod) return -1;
+  self->out.len = 0;
+  rc = self->encode ? _encode(self, in, in_len) : _decode(self, in, in_len);
+  *out = self->out.buf;
+  *out_len = rc ? 0 : self->out.len;
+  return rc;
+}
+
+DLLEXPORT int pdf_filt_hex_finish(PdfFiltHex *self, uint8_t **out, size_t *out_len) {
+  int rc;
+  self->out.len = 0;
+  rc = _finish(self);
+  *out = self->out.buf;
+  *out_len = rc ? 0 : self->out.len;
+  return rc;
+}
+
+DLLEXPORT void pdf_filt_hex_done(PdfFiltHex *self) {
+  if (self) {
+    free(self->out.buf);
+    free(self);
+  }
+}
+
+/* one-shot: the whole input, then hand over the output buffer */
+static int _run(uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len, int encode) {
+  PdfFiltHex *self = pdf_filt_hex_new(encode);
+  int rc = -1;
+
+  *out = NULL;
+  *out_len = 0;
+
+  if (self == NULL) return -1;
+
+  if ((encode ? _encode(self, in, in_len) : _decode(self, in, in_len)) == 0
+      && _finish(self) == 0) {
+    *out = self->out.buf;
+    *out_len = self->out.len;
+    self->out.buf = NULL;
+    rc = 0;
+  }
+
+  pdf_filt_hex_done(self);
+  return rc;
+}
+
+DLLEXPORT int pdf_filt_hex_decode(uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len) {
+  return _run(in, in_len, out, out_len, 0);
+}
+
+DLLEXPORT int pdf_filt_hex_encode(uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len) {
+  return _run(in, in_len, out, out_len, 1);
+}
+
+DLLEXPORT void pdf_filt_hex_free(uint8_t *buf) {
+  free(buf);
+}
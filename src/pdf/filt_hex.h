@@ -0,0 +1,30 @@
+#ifndef PDF_FILT_HEX_H_
+#define PDF_FILT_HEX_H_
+
+/* A streaming ASCIIHex decoder, or encoder; opaque */
+typedef struct PdfFiltHex PdfFiltHex;
+
+DLLEXPORT PdfFiltHex* pdf_filt_hex_new(int encode);
+
+// Consumes in_len bytes. Sets *out to any output, which remains owned by
+// the decoder and is valid until the next call. Returns 0, or -1 on error
+DLLEXPORT int
+pdf_filt_hex_put(PdfFiltHex*,
+                 uint8_t *in,
+                 size_t in_len,
+                 uint8_t **out,
+                 size_t *out_len
+                 );
+
+// Ends the stream. An encoder writes the closing '>'
+DLLEXPORT int pdf_filt_hex_finish(PdfFiltHex*, uint8_t **out, size_t *out_len);
+
+DLLEXPORT void pdf_filt_hex_done(PdfFiltHex*);
+
+// Returns 0 and sets *out, to be freed by pdf_filt_hex_free(), or -1
+DLLEXPORT int pdf_filt_hex_decode(uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len);
+DLLEXPORT int pdf_filt_hex_encode(uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len);
+
+DLLEXPORT void pdf_filt_hex_free(uint8_t *);
+
+#endif
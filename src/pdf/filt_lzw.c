@@ -0,0 +1,397 @@
+/* LZWDecode and LZWEncode, optionally chained with the predictors.
+ *
+ * Codes are 9 to 12 bits, most significant bit first. 256 clears the
+ * table and 257 ends the data. With /EarlyChange 1, the default, the code
+ * width increases one code early.
+ *
+ * The string table is flat: each entry has a prefix code, a final byte and
+ * a length, so nothing is allocated per code. A string is written straight
+ * into the output, backwards from its known length. The encoder finds
+ * (prefix, byte) pairs with a small open-addressed hash.
+ *
+ * Input is accepted in chunks of any size. A partial code is carried
+ * between calls in a bit buffer.
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pdf.h"
+#include "pdf/filt_predict.h"
+#include "pdf/filt_lzw.h"
+#include "pdf/_outbuf.h"
+
+#define PDF_LZW_CLEAR 256
+#define PDF_LZW_EOD   257
+#define PDF_LZW_FIRST 258
+#define PDF_LZW_MAX_WIDTH 12
+#define PDF_LZW_TABLE (1 << PDF_LZW_MAX_WIDTH)
+#define PDF_LZW_HASH_BITS 13
+#define PDF_LZW_HASH  (1 << PDF_LZW_HASH_BITS)
+#define PDF_LZW_CHUNK 16384
+
+struct PdfFiltLZW {
+  PdfFiltPredictor *predictor;  /* NULL, for no prediction */
+  _OutBuf  out;                 /* output from the last call */
+  _OutBuf  rows;                /* between the LZW and predictor stages */
+  uint32_t bits;                /* bit buffer */
+  unsigned nbits;
+  unsigned width;               /* current code width */
+  unsigned next;                /* next free table entry */
+  int      prev;                /* previous code, or current string (encoding), -1 for none */
+  uint8_t  early_change;
+  uint8_t  encode;
+  uint8_t  started;             /* encoding: the initial clear code is written */
+  uint8_t  eod;
+  uint16_t prefix[PDF_LZW_TABLE];
+  uint16_t length[PDF_LZW_TABLE];
+  uint8_t  suffix[PDF_LZW_TABLE];
+  int16_t  hash[PDF_LZW_HASH];  /* encoding only: (prefix, suffix) -> code */
+};
+
+static void _clear(PdfFiltLZW *self) {
+  self->next = PDF_LZW_FIRST;
+  self->width = 9;
+  if (self->encode) memset(self->hash, 0xFF, sizeof(self->hash));
+}
+
+static unsigned _hash(unsigned prefix, uint8_t c) {
+  return (((prefix << 8) | c) * 2654435761u) >> (32 - PDF_LZW_HASH_BITS);
+}
+
+/* write the string for 'code', of length 'len', backwards */
+static void _write_string(PdfFiltLZW *self, unsigned code, uint8_t *out, unsigned len) {
+  uint8_t *p = out + len - 1;
+  while (code >= PDF_LZW_FIRST) {
+    *p-- = self->suffix[code];
+    code = self->prefix[code];
+  }
+  *p = (uint8_t) code;
+}
+
+static int _decode(PdfFiltLZW *self, uint8_t *in, size_t in_len, _OutBuf *ob) {
+  uint32_t bits = self->bits;
+  unsigned nbits = self->nbits;
+  unsigned width = self->width;
+  unsigned next = self->next;
+  int prev = self->prev;
+  int rc = 0;
+
+  while (!self->eod) {
+    unsigned code, len;
+    uint8_t *dst;
+
+    while (nbits < width) {
+      if (in_len == 0) goto done;
+      bits = (bits << 8) | *in++;
+      in_len--;
+      nbits += 8;
+    }
+    nbits -= width;
+    code = (bits >> nbits) & ((1u << width) - 1);
+
+    if (code == PDF_LZW_CLEAR) {
+      next = PDF_LZW_FIRST;
+      width = 9;
+      prev = -1;
+      continue;
+    }
+    if (code == PDF_LZW_EOD) {
+      self->eod = 1;
+      break;
+    }
+
+    if (code < 256) {
+      if (_reserve(ob, 1)) { rc = -1; break; }
+      dst = ob->buf + ob->len;
+      *dst = (uint8_t) code;
+      len = 1;
+    }
+    else if (code < next) {
+      len = self->length[code];
+      if (_reserve(ob, len)) { rc = -1; break; }
+      dst = ob->buf + ob->len;
+      _write_string(self, code, dst, len);
+    }
+    else if (code == next && prev >= 0) {
+      /* the entry being defined: the previous string, then its first byte */
+      len = self->length[prev] + 1;
+      if (_reserve(ob, len)) { rc = -1; break; }
+      dst = ob->buf + ob->len;
+      _write_string(self, prev, dst, len - 1);
+      dst[len - 1] = dst[0];
+    }
+    else {
+      fprintf(stderr, "%s: bad LZW code %u, with %u table entries\n", __FILE__, code, next);
+      rc = -1;
+      break;
+    }
+
+    if (prev >= 0 && next < PDF_LZW_TABLE) {
+      self->prefix[next] = prev;
+      self->suffix[next] = dst[0];
+      self->length[next] = self->length[prev] + 1;
+      next++;
+    }
+    ob->len += len;
+    prev = code;
+    if (next + self->early_change >= (1u << width) && width < PDF_LZW_MAX_WIDTH) width++;
+  }
+
+ done:
+  self->bits = bits;
+  self->nbits = nbits;
+  self->width = width;
+  self->next = next;
+  self->prev = prev;
+  return rc;
+}
+
+static void _put_code(PdfFiltLZW *self, unsigned code, _OutBuf *ob) {
+  self->bits = (self->bits << self->width) | code;
+  self->nbits += self->width;
+  while (self->nbits >= 8) {
+    self->nbits -= 8;
+    ob->buf[ob->len++] = (uint8_t) (self->bits >> self->nbits);
+  }
+}
+
+/* The decoder defines each entry one code later than the encoder, so its
+ * table has next - 1 entries when it reads the code after this one */
+static void _widen(PdfFiltLZW *self) {
+  if (self->next - 1 + self->early_change >= (1u << self->width) && self->width < PDF_LZW_MAX_WIDTH) {
+    self->width++;
+  }
+}
+
+static int _encode(PdfFiltLZW *self, uint8_t *in, size_t in_len, _OutBuf *ob) {
+  int prev = self->prev;
+  size_t i;
+
+  /* each input byte writes at most two codes, of up to 12 bits */
+  if (_reserve(ob, in_len * 3 + 4)) return -1;
+
+  if (!self->started) {
+    /* streams start by clearing the table */
+    _put_code(self, PDF_LZW_CLEAR, ob);
+    self->started = 1;
+  }
+
+  for (i = 0; i < in_len; i++) {
+    uint8_t c = in[i];
+    unsigned h;
+    int code;
+
+    if (prev < 0) {
+      prev = c;
+      continue;
+    }
+
+    h = _hash(prev, c);
+    while ((code = self->hash[h]) >= 0
+           && (self->prefix[code] != prev || self->suffix[code] != c)) {
+      h = (h + 1) & (PDF_LZW_HASH - 1);
+    }
+    if (code >= 0) {
+      prev = code;
+      continue;
+    }
+
+    _put_code(self, prev, ob);
+    self->prefix[self->next] = prev;
+    self->suffix[self->next] = c;
+    self->hash[h] = self->next++;
+    _widen(self);
+    if (self->next == PDF_LZW_TABLE) {
+      _put_code(self, PDF_LZW_CLEAR, ob);
+      _clear(self);
+    }
+    prev = c;
+  }
+
+  self->prev = prev;
+  return 0;
+}
+
+static int _finish(PdfFiltLZW *self, _OutBuf *ob) {
+  if (self->encode && !self->eod) {
+    if (_encode(self, NULL, 0, ob) || _reserve(ob, 5)) return -1;
+    if (self->prev >= 0) {
+      _put_code(self, self->prev, ob);
+      /* the decoder defines an entry as it reads this code */
+      self->next++;
+      _widen(self);
+    }
+    _put_code(self, PDF_LZW_EOD, ob);
+    if (self->nbits) {
+      ob->buf[ob->len++] = (uint8_t) (self->bits << (8 - self->nbits));
+      self->nbits = 0;
+    }
+    self->eod = 1;
+  }
+  return 0;
+}
+
+DLLEXPORT PdfFiltLZW*
+pdf_filt_lzw_new(uint8_t early_change,
+                 int encode,
+                 uint8_t predictor,
+                 uint8_t colors,
+                 uint8_t bpc,
+                 uint16_t columns
+                 ) {
+  PdfFiltLZW *self = calloc(1, sizeof(PdfFiltLZW));
+  unsigned i;
+
+  if (self == NULL) return NULL;
+
+  if (predictor != PDF_FILTER_NO_PREDICTION) {
+    self->predictor = pdf_filt_predictor_new(predictor, colors, bpc, columns, encode);
+    if (self->predictor == NULL) {
+      free(self);
+      return NULL;
+    }
+  }
+
+  for (i = 0; i < 256; i++) {
+    self->suffix[i] = i;
+    self->length[i] = 1;
+  }
+  self->early_change = early_change ? 1 : 0;
+  self->encode = encode ? 1 : 0;
+  self->prev = -1;
+  _clear(self);
+
+  return self;
+}
+
+/* as pdf_filt_lzw_put(), appending to self->out */
+static int _put(PdfFiltLZW *self, uint8_t *in, size_t in_len) {
+  if (self->predictor == NULL) {
+    return self->encode
+      ? _encode(self, in, in_len, &self->out)
+      : _decode(self, in, in_len, &self->out);
+  }
+  else if (self->encode) {
+    size_t n = pdf_filt_predictor_out_size(self->predictor, in_len);
+    self->rows.len = 0;
+    if (in_len == 0) return 0;
+    if (_reserve(&self->rows, n)
+        || pdf_filt_predictor_put(self->predictor, in, in_len, self->rows.buf, &self->rows.len)) {
+      return -1;
+    }
+    return _encode(self, self->rows.buf, self->rows.len, &self->out);
+  }
+  else {
+    size_t n, len;
+    self->rows.len = 0;
+    if (_decode(self, in, in_len, &self->rows)) return -1;
+    if (self->rows.len == 0) return 0;
+    n = pdf_filt_predictor_out_size(self->predictor, self->rows.len);
+    if (_reserve(&self->out, n)
+        || pdf_filt_predictor_put(self->predictor, self->rows.buf, self->rows.len, self->out.buf + self->out.len, &len)) {
+      return -1;
+    }
+    self->out.len += len;
+    return 0;
+  }
+}
+
+DLLEXPORT int
+pdf_filt_lzw_put(PdfFiltLZW *self,
+                 uint8_t *in,
+                 size_t in_len,
+                 uint8_t **out,
+                 size_t *out_len
+                 ) {
+  int rc;
+  if (self->encode && self->eod) return -1;
+  self->out.len = 0;
+  rc = _put(self, in, in_len);
+  *out = self->out.buf;
+  *out_len = rc ? 0 : self->out.len;
+  return rc;
+}
+
+DLLEXPORT int pdf_filt_lzw_finish(PdfFiltLZW *self, uint8_t **out, size_t *out_len) {
+  int rc;
+  self->out.len = 0;
+  rc = _finish(self, &self->out);
+  *out = self->out.buf;
+  *out_len = rc ? 0 : self->out.len;
+  return rc;
+}
+
+DLLEXPORT void pdf_filt_lzw_done(PdfFiltLZW *self) {
+  if (self) {
+    pdf_filt_predictor_done(self->predictor);
+    free(self->out.buf);
+    free(self->rows.buf);
+    free(self);
+  }
+}
+
+/* one-shot: the whole input, then hand over the output buffer */
+static int _run(uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len,
+                uint8_t early_change, int encode,
+                uint8_t predictor, uint8_t colors, uint8_t bpc, uint16_t columns) {
+  PdfFiltLZW *self = pdf_filt_lzw_new(early_change, encode, predictor, colors, bpc, columns);
+  int rc = -1;
+
+  *out = NULL;
+  *out_len = 0;
+
+  if (self == NULL) return -1;
+
+  while (in_len) {
+    /* bound the predictor stage's buffer */
+    size_t n = self->predictor && in_len > PDF_LZW_CHUNK ? PDF_LZW_CHUNK : in_len;
+    if (_put(self, in, n)) goto fail;
+    in += n;
+    in_len -= n;
+  }
+  if (_finish(self, &self->out)) goto fail;
+
+  *out = self->out.buf;
+  *out_len = self->out.len;
+  self->out.buf = NULL;
+  rc = 0;
+
+ fail:
+  pdf_filt_lzw_done(self);
+  return rc;
+}
+
+DLLEXPORT int
+pdf_filt_lzw_decode(uint8_t *in,
+                    size_t in_len,
+                    uint8_t **out,
+                    size_t *out_len,
+                    uint8_t early_change,
+                    uint8_t predictor,
+                    uint8_t colors,
+                    uint8_t bpc,
+                    uint16_t columns
+                    ) {
+  return _run(in, in_len, out, out_len, early_change, 0, predictor, colors, bpc, columns);
+}
+
+DLLEXPORT int
+pdf_filt_lzw_encode(uint8_t *in,
+                    size_t in_len,
+                    uint8_t **out,
+                    size_t *out_len,
+                    uint8_t early_change,
+                    uint8_t predictor,
+                    uint8_t colors,
+                    uint8_t bpc,
+                    uint16_t columns
+                    ) {
+  return _run(in, in_len, out, out_len, early_change, 1, predictor, colors, bpc, columns);
+}
+
+DLLEXPORT void pdf_filt_lzw_free(uint8_t *buf) {
+  free(buf);
+}
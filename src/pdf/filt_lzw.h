@@ -0,0 +1,64 @@
+#ifndef PDF_FILT_LZW_H_
+#define PDF_FILT_LZW_H_
+
+/* A streaming LZW decoder, or encoder, optionally chained with a
+ * streaming predictor; opaque */
+typedef struct PdfFiltLZW PdfFiltLZW;
+
+// Returns a new decoder, or encoder, or NULL for an unknown predictor.
+// early_change is /EarlyChange, normally 1
+DLLEXPORT PdfFiltLZW*
+pdf_filt_lzw_new(uint8_t early_change,
+                 int encode,
+                 uint8_t predictor,
+                 uint8_t colors,
+                 uint8_t bpc,
+                 uint16_t columns
+                 );
+
+// Consumes in_len bytes. Sets *out to any output, which remains owned by
+// the decoder and is valid until the next call. Returns 0, or -1 on error
+DLLEXPORT int
+pdf_filt_lzw_put(PdfFiltLZW*,
+                 uint8_t *in,
+                 size_t in_len,
+                 uint8_t **out,
+                 size_t *out_len
+                 );
+
+// Ends the stream. An encoder writes its last code, EOD and padding
+DLLEXPORT int pdf_filt_lzw_finish(PdfFiltLZW*, uint8_t **out, size_t *out_len);
+
+DLLEXPORT void pdf_filt_lzw_done(PdfFiltLZW*);
+
+// LZW decode, then decode None, TIFF or PNG predictors.
+// Returns 0 and sets *out, to be freed by pdf_filt_lzw_free(), or -1
+DLLEXPORT int
+pdf_filt_lzw_decode(uint8_t *in,
+                    size_t in_len,
+                    uint8_t **out,
+                    size_t *out_len,
+                    uint8_t early_change,
+                    uint8_t predictor,
+                    uint8_t colors,
+                    uint8_t bpc,
+                    uint16_t columns
+                    );
+
+// Encode None, TIFF or PNG predictors, then LZW encode.
+// Returns 0 and sets *out, to be freed by pdf_filt_lzw_free(), or -1
+DLLEXPORT int
+pdf_filt_lzw_encode(uint8_t *in,
+                    size_t in_len,
+                    uint8_t **out,
+                    size_t *out_len,
+                    uint8_t early_change,
+                    uint8_t predictor,
+                    uint8_t colors,
+                    uint8_t bpc,
+                    uint16_t columns
+                    );
+
+DLLEXPORT void pdf_filt_lzw_free(uint8_t *);
+
+#endif
@@ -0,0 +1,404 @@
+/* Decodes, or encodes, stream data through the filters named by its
+ * dictionary's /Filter and /DecodeParms entries.
+ *
+ * Each filter is a streaming stage: the input is fed through in chunks of
+ * PDF_PIPELINE_CHUNK bytes, and the output of each stage is passed directly
+ * to the next. So intermediate buffers are sized by a chunk, rather than by
+ * the whole of the data, and nothing goes back through the FFI between
+ * stages.
+ *
+ * Handles FlateDecode, LZWDecode (with predictors), ASCIIHexDecode,
+ * ASCII85Decode and RunLengthDecode, and their inline image abbreviations.
+ * Anything else is PDF_FILT_UNSUPPORTED, for the caller to handle.
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pdf.h"
+#include "pdf/cos.h"
+#include "pdf/filt_predict.h"
+#include "pdf/filt_flate.h"
+#include "pdf/filt_lzw.h"
+#include "pdf/filt_hex.h"
+#include "pdf/filt_ascii85.h"
+#include "pdf/filt_runlength.h"
+#include "pdf/filt_pipeline.h"
+#include "pdf/_outbuf.h"
+
+#define PDF_PIPELINE_CHUNK 16384
+#define PDF_PIPELINE_MAX_STAGES 8
+#define PDF_PIPELINE_MAX_KEY 16
+/* zlib's default compression level */
+#define PDF_PIPELINE_FLATE_LEVEL -1
+
+typedef enum {
+  PDF_PIPE_FLATE,
+  PDF_PIPE_LZW,
+  PDF_PIPE_HEX,
+  PDF_PIPE_ASCII85,
+  PDF_PIPE_RUNLENGTH,
+} _StageType;
+
+static const struct {
+  const char *name;
+  const char *abbrev;
+  _StageType type;
+} _filters[] = {
+  { "FlateDecode",     "Fl",  PDF_PIPE_FLATE },
+  { "LZWDecode",       "LZW", PDF_PIPE_LZW },
+  { "ASCIIHexDecode",  "AHx", PDF_PIPE_HEX },
+  { "ASCII85Decode",   "A85", PDF_PIPE_ASCII85 },
+  { "RunLengthDecode", "RL",  PDF_PIPE_RUNLENGTH },
+};
+
+typedef struct {
+  _StageType type;
+  union {
+    PdfFiltFlate *flate;
+    PdfFiltLZW *lzw;
+    PdfFiltHex *hex;
+    PdfFiltASCII85 *ascii85;
+    PdfFiltRunLength *runlength;
+  };
+} _Stage;
+
+typedef struct {
+  _Stage stages[PDF_PIPELINE_MAX_STAGES];
+  int n;
+  PdfFiltSink sink;
+  void *ctx;
+} _Pipeline;
+
+/* /DecodeParms */
+typedef struct {
+  uint8_t  predictor;
+  uint8_t  colors;
+  uint8_t  bpc;
+  uint8_t  early_change;
+  uint16_t columns;
+} _Parms;
+
+static int _name_is(CosName *name, const char *s) {
+  uint16_t i;
+  for (i = 0; i < name->value_len; i++) {
+    if (s[i] == 0 || name->value[i] != (uint8_t) s[i]) return 0;
+  }
+  return s[i] == 0;
+}
+
+/* looks up a key, given as ASCII; treats null as absent */
+static CosNode* _lookup(CosDict *dict, const char *key) {
+  PDF_TYPE_CODE_POINT value[PDF_PIPELINE_MAX_KEY];
+  uint16_t i;
+  CosName *name;
+  CosNode *node;
+
+  for (i = 0; key[i]; i++) value[i] = (uint8_t) key[i];
+  name = cos_name_new(value, i);
+  node = cos_dict_lookup(dict, name);
+  cos_node_done((CosNode*) name);
+
+  return node && node->type != COS_NODE_NULL ? node : NULL;
+}
+
+static int _int_param(CosDict *dict, const char *key, PDF_TYPE_INT64 min, PDF_TYPE_INT64 max, PDF_TYPE_INT64 *value) {
+  CosNode *node = dict ? _lookup(dict, key) : NULL;
+  if (node == NULL) return 0;
+  if (node->type == COS_NODE_REF) return PDF_FILT_UNSUPPORTED;
+  if (node->type != COS_NODE_INT
+      || ((CosInt*) node)->value < min
+      || ((CosInt*) node)->value > max) {
+    fprintf(stderr, "%s: bad /DecodeParms /%s entry\n", __FILE__, key);
+    return -1;
+  }
+  *value = ((CosInt*) node)->value;
+  return 0;
+}
+
+static int _parms(CosNode *node, _Parms *parms) {
+  CosDict *dict = NULL;
+  PDF_TYPE_INT64 predictor = PDF_FILTER_NO_PREDICTION;
+  PDF_TYPE_INT64 colors = 1, bpc = 8, columns = 1, early_change = 1;
+  int rc;
+
+  if (node) {
+    if (node->type == COS_NODE_REF) return PDF_FILT_UNSUPPORTED;
+    if (node->type != COS_NODE_DICT) {
+      fprintf(stderr, "%s: /DecodeParms is not a dictionary\n", __FILE__);
+      return -1;
+    }
+    dict = (CosDict*) node;
+  }
+
+  if ((rc = _int_param(dict, "Predictor", 1, 255, &predictor))
+      || (rc = _int_param(dict, "Colors", 1, 255, &colors))
+      || (rc = _int_param(dict, "BitsPerComponent", 1, 16, &bpc))
+      || (rc = _int_param(dict, "Columns", 1, UINT16_MAX, &columns))
+      || (rc = _int_param(dict, "EarlyChange", 0, 1, &early_change))) {
+    return rc;
+  }
+  switch (bpc) {
+  case 1: case 2: case 4: case 8: case 16:
+    break;
+  default:
+    fprintf(stderr, "%s: bad /DecodeParms /BitsPerComponent entry\n", __FILE__);
+    return -1;
+  }
+
+  parms->predictor = predictor;
+  parms->colors = colors;
+  parms->bpc = bpc;
+  parms->columns = columns;
+  parms->early_change = early_change;
+  return 0;
+}
+
+static int _stage_new(_Stage *stage, CosNode *filter, CosNode *decode_parms, int encode) {
+  CosName *name;
+  _Parms parms;
+  size_t i;
+  int rc;
+
+  if (filter->type == COS_NODE_REF) return PDF_FILT_UNSUPPORTED;
+  if (filter->type != COS_NODE_NAME) {
+    fprintf(stderr, "%s: /Filter is not a name\n", __FILE__);
+    return -1;
+  }
+  name = (CosName*) filter;
+
+  for (i = 0; i < sizeof(_filters) / sizeof(_filters[0]); i++) {
+    if (_name_is(name, _filters[i].name) || _name_is(name, _filters[i].abbrev)) break;
+  }
+  if (i == sizeof(_filters) / sizeof(_filters[0])) return PDF_FILT_UNSUPPORTED;
+
+  if ((rc = _parms(decode_parms, &parms))) return rc;
+
+  stage->type = _filters[i].type;
+  switch (stage->type) {
+  case PDF_PIPE_FLATE:
+    stage->flate = pdf_filt_flate_new(encode, parms.predictor, parms.colors, parms.bpc,
+                                      parms.columns, PDF_PIPELINE_FLATE_LEVEL);
+    return stage->flate ? 0 : -1;
+  case PDF_PIPE_LZW:
+    stage->lzw = pdf_filt_lzw_new(parms.early_change, encode, parms.predictor, parms.colors,
+                                  parms.bpc, parms.columns);
+    return stage->lzw ? 0 : -1;
+  case PDF_PIPE_HEX:
+    stage->hex = pdf_filt_hex_new(encode);
+    return stage->hex ? 0 : -1;
+  case PDF_PIPE_ASCII85:
+    stage->ascii85 = pdf_filt_ascii85_new(encode);
+    return stage->ascii85 ? 0 : -1;
+  case PDF_PIPE_RUNLENGTH:
+    stage->runlength = pdf_filt_runlength_new(encode);
+    return stage->runlength ? 0 : -1;
+  }
+  return -1;
+}
+
+static int _stage_put(_Stage *stage, uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len) {
+  switch (stage->type) {
+  case PDF_PIPE_FLATE:     return pdf_filt_flate_put(stage->flate, in, in_len, out, out_len);
+  case PDF_PIPE_LZW:       return pdf_filt_lzw_put(stage->lzw, in, in_len, out, out_len);
+  case PDF_PIPE_HEX:       return pdf_filt_hex_put(stage->hex, in, in_len, out, out_len);
+  case PDF_PIPE_ASCII85:   return pdf_filt_ascii85_put(stage->ascii85, in, in_len, out, out_len);
+  case PDF_PIPE_RUNLENGTH: return pdf_filt_runlength_put(stage->runlength, in, in_len, out, out_len);
+  }
+  return -1;
+}
+
+static int _stage_finish(_Stage *stage, uint8_t **out, size_t *out_len) {
+  switch (stage->type) {
+  case PDF_PIPE_FLATE:     return pdf_filt_flate_finish(stage->flate, out, out_len);
+  case PDF_PIPE_LZW:       return pdf_filt_lzw_finish(stage->lzw, out, out_len);
+  case PDF_PIPE_HEX:       return pdf_filt_hex_finish(stage->hex, out, out_len);
+  case PDF_PIPE_ASCII85:   return pdf_filt_ascii85_finish(stage->ascii85, out, out_len);
+  case PDF_PIPE_RUNLENGTH: return pdf_filt_runlength_finish(stage->runlength, out, out_len);
+  }
+  return -1;
+}
+
+static void _stage_done(_Stage *stage) {
+  switch (stage->type) {
+  case PDF_PIPE_FLATE:     pdf_filt_flate_done(stage->flate); break;
+  case PDF_PIPE_LZW:       pdf_filt_lzw_done(stage->lzw); break;
+  case PDF_PIPE_HEX:       pdf_filt_hex_done(stage->hex); break;
+  case PDF_PIPE_ASCII85:   pdf_filt_ascii85_done(stage->ascii85); break;
+  case PDF_PIPE_RUNLENGTH: pdf_filt_runlength_done(stage->runlength); break;
+  }
+}
+
+static void _pipeline_done(_Pipeline *self) {
+  while (self->n > 0) _stage_done(&self->stages[--self->n]);
+}
+
+/* Builds the stages from /Filter and /DecodeParms; in reverse order, for
+ * encoding */
+static int _pipeline_init(_Pipeline *self, CosNode *filter, CosNode *decode_parms, int encode) {
+  CosNode **filters = &filter;
+  CosNode **parms = decode_parms ? &decode_parms : NULL;
+  size_t n = filter ? 1 : 0;
+  size_t i;
+
+  self->n = 0;
+
+  if (filter && filter->type == COS_NODE_ARRAY) {
+    CosArray *a = (CosArray*) filter;
+    filters = a->values;
+    n = a->elems;
+    if (decode_parms && decode_parms->type == COS_NODE_ARRAY) {
+      CosArray *p = (CosArray*) decode_parms;
+      if (p->elems != n) {
+        fprintf(stderr, "%s: /DecodeParms and /Filter arrays differ in length\n", __FILE__);
+        return -1;
+      }
+      parms = p->values;
+    }
+    else if (decode_parms && n > 1) {
+      fprintf(stderr, "%s: /DecodeParms is not an array\n", __FILE__);
+      return -1;
+    }
+  }
+  else if (decode_parms && decode_parms->type == COS_NODE_ARRAY) {
+    CosArray *p = (CosArray*) decode_parms;
+    if (p->elems != 1) {
+      fprintf(stderr, "%s: /DecodeParms and /Filter arrays differ in length\n", __FILE__);
+      return -1;
+    }
+    parms = p->values;
+  }
+
+  if (n > PDF_PIPELINE_MAX_STAGES) {
+    fprintf(stderr, "%s: too many filters: %d\n", __FILE__, (int) n);
+    return -1;
+  }
+
+  for (i = 0; i < n; i++) {
+    size_t j = encode ? n - 1 - i : i;
+    CosNode *p = parms && parms[j] && parms[j]->type != COS_NODE_NULL ? parms[j] : NULL;
+    int rc = _stage_new(&self->stages[i], filters[j], p, encode);
+    if (rc) {
+      _pipeline_done(self);
+      return rc;
+    }
+    self->n++;
+  }
+
+  return 0;
+}
+
+/* passes a buffer through stages i and on, then to the sink */
+static int _push(_Pipeline *self, int i, uint8_t *buf, size_t len) {
+  for (; i < self->n; i++) {
+    if (len == 0) return 0;
+    if (_stage_put(&self->stages[i], buf, len, &buf, &len)) return -1;
+  }
+  if (len && self->sink(self->ctx, buf, len)) return -1;
+  return 0;
+}
+
+static int _pipeline_run(_Pipeline *self, uint8_t *in, size_t in_len) {
+  int i;
+
+  while (in_len) {
+    size_t n = in_len > PDF_PIPELINE_CHUNK ? PDF_PIPELINE_CHUNK : in_len;
+    if (_push(self, 0, in, n)) return -1;
+    in += n;
+    in_len -= n;
+  }
+
+  /* each stage's final output goes through the remaining stages, before
+   * they in turn are finished */
+  for (i = 0; i < self->n; i++) {
+    uint8_t *buf;
+    size_t len;
+    if (_stage_finish(&self->stages[i], &buf, &len)
+        || _push(self, i + 1, buf, len)) {
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+static int _run(CosNode *filter, CosNode *decode_parms, int encode,
+                uint8_t *in, size_t in_len, PdfFiltSink sink, void *ctx) {
+  _Pipeline pipeline;
+  int rc = _pipeline_init(&pipeline, filter, decode_parms, encode);
+
+  if (rc) return rc;
+  pipeline.sink = sink;
+  pipeline.ctx = ctx;
+  rc = _pipeline_run(&pipeline, in, in_len);
+  _pipeline_done(&pipeline);
+
+  return rc;
+}
+
+static int _collect(void *ctx, uint8_t *buf, size_t len) {
+  _OutBuf *ob = ctx;
+  if (_reserve(ob, len)) return -1;
+  memcpy(ob->buf + ob->len, buf, len);
+  ob->len += len;
+  return 0;
+}
+
+DLLEXPORT int pdf_filt_pipeline_decode_to(CosStream *self, PdfFiltSink sink, void *ctx) {
+  CosNode *filter = _lookup(self->dict, "Filter");
+  CosNode *decode_parms = _lookup(self->dict, "DecodeParms");
+
+  if (self->type == COS_NODE_INLINE_IMAGE) {
+    /* abbreviated keys */
+    if (filter == NULL) filter = _lookup(self->dict, "F");
+    if (decode_parms == NULL) decode_parms = _lookup(self->dict, "DP");
+  }
+
+  if (self->value == NULL) {
+    fprintf(stderr, "%s: stream data is not attached\n", __FILE__);
+    return -1;
+  }
+
+  return _run(filter, decode_parms, 0, (uint8_t*) self->value, self->value_len, sink, ctx);
+}
+
+DLLEXPORT int pdf_filt_pipeline_decode(CosStream *self, uint8_t **out, size_t *out_len) {
+  _OutBuf ob = { NULL, 0, 0 };
+  int rc = pdf_filt_pipeline_decode_to(self, _collect, &ob);
+
+  if (rc) {
+    free(ob.buf);
+    ob.buf = NULL;
+    ob.len = 0;
+  }
+  *out = ob.buf;
+  *out_len = ob.len;
+  return rc;
+}
+
+DLLEXPORT int
+pdf_filt_pipeline_encode(CosDict *dict,
+                         uint8_t *in,
+                         size_t in_len,
+                         uint8_t **out,
+                         size_t *out_len
+                         ) {
+  _OutBuf ob = { NULL, 0, 0 };
+  int rc = _run(_lookup(dict, "Filter"), _lookup(dict, "DecodeParms"), 1,
+                in, in_len, _collect, &ob);
+
+  if (rc) {
+    free(ob.buf);
+    ob.buf = NULL;
+    ob.len = 0;
+  }
+  *out = ob.buf;
+  *out_len = ob.len;
+  return rc;
+}
+
+DLLEXPORT void pdf_filt_pipeline_free(uint8_t *buf) {
+  free(buf);
+}
@@ -0,0 +1,31 @@
+#ifndef PDF_FILT_PIPELINE_H_
+#define PDF_FILT_PIPELINE_H_
+
+/* Returned for a /Filter or /DecodeParms entry that isn't handled natively,
+ * such as /DCTDecode, or an indirect reference */
+#define PDF_FILT_UNSUPPORTED -2
+
+// Receives each piece of output; returns 0, or non-zero to stop
+typedef int (*PdfFiltSink)(void *ctx, uint8_t *buf, size_t len);
+
+// Decodes a stream's data, or an inline image's, through its /Filter chain
+// and /DecodeParms, passing the output to sink. Returns 0, -1 on error, or
+// PDF_FILT_UNSUPPORTED
+DLLEXPORT int pdf_filt_pipeline_decode_to(CosStream*, PdfFiltSink sink, void *ctx);
+
+// As above. Sets *out, to be freed by pdf_filt_pipeline_free()
+DLLEXPORT int pdf_filt_pipeline_decode(CosStream*, uint8_t **out, size_t *out_len);
+
+// Encodes data for a stream with the given dictionary, applying its /Filter
+// chain in reverse. Sets *out, to be freed by pdf_filt_pipeline_free()
+DLLEXPORT int
+pdf_filt_pipeline_encode(CosDict*,
+                         uint8_t *in,
+                         size_t in_len,
+                         uint8_t **out,
+                         size_t *out_len
+                         );
+
+DLLEXPORT void pdf_filt_pipeline_free(uint8_t *);
+
+#endif
@@ -1,11 +1,18 @@
 #include <stdio.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include "pdf.h"
 #include "pdf/filt_predict.h"
 #include "pdf/filt_predict_tiff.h"
 #include "pdf/filt_predict_png.h"
+#include "pdf/_thread.h"
+
+/* Threaded predictors split the image into one band of rows per thread.
+ * Bands below this size aren't worth a thread. */
+#define PDF_PREDICT_MIN_BAND_BYTES (256 * 1024)
+#define PDF_PREDICT_MAX_THREADS 64
 
 DLLEXPORT void
 pdf_filt_predict_decode(
@@ -78,3 +85,324 @@ pdf_filt_predict_encode(
     break;
   }
 }
+
+typedef struct {
+  uint8_t *in;
+  uint8_t *out;
+  uint8_t *prev;         /* input row before the band (PNG encoding) */
+  uint8_t predictor;
+  uint8_t colors;
+  uint8_t bpc;
+  uint16_t columns;
+  size_t rows;
+  int encode;
+  int packed;            /* TIFF predictors on packed rows */
+} _Band;
+
+static void _band_run(_Band *b) {
+  if (b->packed) {
+    if (b->encode) {
+      pdf_filt_predict_tiff_encode_packed(b->in, b->out, b->colors, b->bpc, b->columns, b->rows);
+    }
+    else {
+      pdf_filt_predict_tiff_decode_packed(b->in, b->out, b->colors, b->bpc, b->columns, b->rows);
+    }
+  }
+  else if (b->encode) {
+    if (b->predictor == PDF_FILTER_TIFF_PREDICTOR) {
+      pdf_filt_predict_tiff_encode(b->in, b->out, b->colors, b->bpc, b->columns, b->rows);
+    }
+    else {
+      pdf_filt_predict_png_encode_band(b->in, b->out, b->prev, b->colors, b->bpc, b->columns, b->rows, b->predictor);
+    }
+  }
+  else {
+    pdf_filt_predict_tiff_decode(b->in, b->out, b->colors, b->bpc, b->columns, b->rows);
+  }
+}
+
+_THREAD_FUNC(_band_thread) {
+  _band_run((_Band*) arg);
+  _THREAD_RETURN;
+}
+
+/* Run bands of rows concurrently. Input and output row sizes are in bytes.
+ * Returns 0 if there's too little work for more than one band. */
+static int
+_run_bands(uint8_t *in,
+           uint8_t *out,
+           size_t in_row,
+           size_t out_row,
+           uint8_t predictor,
+           uint8_t colors,
+           uint8_t bpc,
+           uint16_t columns,
+           size_t rows,
+           int threads,
+           int encode,
+           int packed
+           ) {
+  _Band bands[PDF_PREDICT_MAX_THREADS];
+  _thread_t tids[PDF_PREDICT_MAX_THREADS];
+  size_t max_bands = (in_row * rows) / PDF_PREDICT_MIN_BAND_BYTES;
+  size_t row = 0, per_band;
+  int n, t, started = 0;
+
+  if (threads > PDF_PREDICT_MAX_THREADS) threads = PDF_PREDICT_MAX_THREADS;
+  if ((size_t) threads > max_bands) threads = (int) max_bands;
+  if ((size_t) threads > rows) threads = (int) rows;
+  if (threads < 2) return 0;
+
+  per_band = (rows + threads - 1) / threads;
+  for (n = 0; n < threads && row < rows; n++) {
+    _Band *b = &bands[n];
+    b->in = in + row * in_row;
+    b->out = out + row * out_row;
+    b->prev = row ? b->in - in_row : NULL;
+    b->predictor = predictor;
+    b->colors = colors;
+    b->bpc = bpc;
+    b->columns = columns;
+    b->rows = rows - row < per_band ? rows - row : per_band;
+    b->encode = encode;
+    b->packed = packed;
+    row += b->rows;
+  }
+
+  /* the calling thread runs the first band */
+  for (t = 1; t < n; t++) {
+    if (_thread_create(&tids[started], _band_thread, &bands[t]) != 0) break;
+    started++;
+  }
+  _band_run(&bands[0]);
+  /* run any bands that we couldn't start a thread for */
+  for (t = started + 1; t < n; t++) {
+    _band_run(&bands[t]);
+  }
+  for (t = 0; t < started; t++) {
+    _thread_join(tids[t]);
+  }
+  return 1;
+}
+
+/* bytes per unpacked TIFF sample */
+static size_t _tiff_sample_size(uint8_t bpc) {
+  return bpc > 8 ? bpc / 8 : 1;
+}
+
+DLLEXPORT void
+pdf_filt_predict_decode_mt(
+                           uint8_t *in,
+                           uint8_t *out,
+                           uint8_t predictor,
+                           uint8_t colors,
+                           uint8_t bpc,
+                           uint16_t columns,
+                           size_t rows,
+                           int threads
+                   ) {
+  /* PNG decoding depends on the previous decoded row, so stays sequential */
+  if (predictor == PDF_FILTER_TIFF_PREDICTOR) {
+    size_t row_size = colors * columns * _tiff_sample_size(bpc);
+    if (_run_bands(in, out, row_size, row_size, predictor, colors, bpc, columns, rows, threads, 0, 0)) {
+      return;
+    }
+  }
+  pdf_filt_predict_decode(in, out, predictor, colors, bpc, columns, rows);
+}
+
+DLLEXPORT void
+pdf_filt_predict_encode_mt(
+                           uint8_t *in,
+                           uint8_t *out,
+                           uint8_t predictor,
+                           uint8_t colors,
+                           uint8_t bpc,
+                           uint16_t columns,
+                           size_t rows,
+                           int threads
+                   ) {
+  if (predictor == PDF_FILTER_TIFF_PREDICTOR) {
+    size_t row_size = colors * columns * _tiff_sample_size(bpc);
+    if (_run_bands(in, out, row_size, row_size, predictor, colors, bpc, columns, rows, threads, 1, 0)) {
+      return;
+    }
+  }
+  else if (predictor >= PDF_FILTER_PNG_NONE_ALL_ROWS && predictor <= PDF_FILTER_PNG_OPTIMUM) {
+    size_t row_size = (colors * bpc * columns + 7) / 8;
+    if (_run_bands(in, out, row_size, row_size + 1, predictor, colors, bpc, columns, rows, threads, 1, 0)) {
+      return;
+    }
+  }
+  pdf_filt_predict_encode(in, out, predictor, colors, bpc, columns, rows);
+}
+
+DLLEXPORT void
+pdf_filt_predict_tiff_decode_packed_mt(
+                                       uint8_t *in,
+                                       uint8_t *out,
+                                       uint8_t colors,
+                                       uint8_t bpc,
+                                       uint16_t columns,
+                                       size_t rows,
+                                       int threads
+                   ) {
+  size_t row_size = ((size_t) colors * bpc * columns + 7) / 8;
+  if (!_run_bands(in, out, row_size, row_size, PDF_FILTER_TIFF_PREDICTOR, colors, bpc, columns, rows, threads, 0, 1)) {
+    pdf_filt_predict_tiff_decode_packed(in, out, colors, bpc, columns, rows);
+  }
+}
+
+DLLEXPORT void
+pdf_filt_predict_tiff_encode_packed_mt(
+                                       uint8_t *in,
+                                       uint8_t *out,
+                                       uint8_t colors,
+                                       uint8_t bpc,
+                                       uint16_t columns,
+                                       size_t rows,
+                                       int threads
+                   ) {
+  size_t row_size = ((size_t) colors * bpc * columns + 7) / 8;
+  if (!_run_bands(in, out, row_size, row_size, PDF_FILTER_TIFF_PREDICTOR, colors, bpc, columns, rows, threads, 1, 1)) {
+    pdf_filt_predict_tiff_encode_packed(in, out, colors, bpc, columns, rows);
+  }
+}
+
+DLLEXPORT PdfFiltPredictor*
+pdf_filt_predictor_new(uint8_t predictor,
+                       uint8_t colors,
+                       uint8_t bpc,
+                       uint16_t columns,
+                       int encode
+                       ) {
+  PdfFiltPredictor *self;
+  size_t row_size = ((size_t) colors * bpc * columns + 7) / 8;
+  int png = predictor >= PDF_FILTER_PNG_NONE_ALL_ROWS && predictor <= PDF_FILTER_PNG_OPTIMUM;
+
+  if (predictor != PDF_FILTER_NO_PREDICTION && predictor != PDF_FILTER_TIFF_PREDICTOR && !png) {
+    fprintf(stderr, "%s: unknown predictor-type: %d\n", __FILE__, predictor);
+    return NULL;
+  }
+  if (row_size == 0) return NULL;
+
+  self = calloc(1, sizeof(PdfFiltPredictor));
+  if (self == NULL) return NULL;
+  self->row_size = row_size;
+  self->in_size  = row_size + (png && !encode);
+  self->out_size = row_size + (png && encode);
+  self->partial  = malloc(self->in_size);
+  self->prev     = malloc(row_size);
+  if (self->partial == NULL || self->prev == NULL) {
+    pdf_filt_predictor_done(self);
+    return NULL;
+  }
+  self->columns   = columns;
+  self->predictor = predictor;
+  self->colors    = colors;
+  self->bpc       = bpc;
+  self->bpp       = pdf_filt_predict_png_bpp(colors, bpc);
+  self->encode    = encode ? 1 : 0;
+  return self;
+}
+
+DLLEXPORT size_t pdf_filt_predictor_out_size(PdfFiltPredictor *self, size_t in_len) {
+  return ((self->partial_len + in_len) / self->in_size) * self->out_size;
+}
+
+/* decode or encode one row; prev is NULL for the first row */
+static int _predictor_row(PdfFiltPredictor *self, uint8_t *in, uint8_t *out, uint8_t *prev) {
+  switch (self->predictor) {
+  case PDF_FILTER_NO_PREDICTION:
+    memcpy(out, in, self->row_size);
+    break;
+  case PDF_FILTER_TIFF_PREDICTOR:
+    return self->encode
+      ? pdf_filt_predict_tiff_encode_row(in, out, self->colors, self->bpc, self->columns)
+      : pdf_filt_predict_tiff_decode_row(in, out, self->colors, self->bpc, self->columns);
+  default:
+    if (self->encode) {
+      uint8_t tag = self->predictor == PDF_FILTER_PNG_OPTIMUM
+        ? pdf_filt_predict_png_select_row(in, prev, self->row_size, self->bpp)
+        : self->predictor - PDF_FILTER_PNG_NONE_ALL_ROWS;
+      *out = tag;
+      pdf_filt_predict_png_encode_row(tag, in, out + 1, prev, self->row_size, self->bpp);
+    }
+    else {
+      return pdf_filt_predict_png_decode_row(in[0], in + 1, out, prev, self->row_size, self->bpp);
+    }
+  }
+  return 0;
+}
+
+DLLEXPORT int
+pdf_filt_predictor_put(PdfFiltPredictor *self,
+                       uint8_t *in,
+                       size_t in_len,
+                       uint8_t *out,
+                       size_t *out_len
+                       ) {
+  uint8_t *prev = self->rows ? self->prev : NULL;
+  /* the last decoded row in out, or input row in 'in' */
+  uint8_t *last = NULL;
+  size_t n = 0;
+
+  *out_len = 0;
+
+  if (self->partial_len) {
+    /* complete the buffered row */
+    size_t fill = self->in_size - self->partial_len;
+    if (fill > in_len) fill = in_len;
+    memcpy(self->partial + self->partial_len, in, fill);
+    self->partial_len += fill;
+    in += fill;
+    in_len -= fill;
+    if (self->partial_len < self->in_size) return 0;
+
+    if (_predictor_row(self, self->partial, out, prev)) return -1;
+    self->partial_len = 0;
+    if (self->encode) {
+      /* the previous input row must outlive the partial buffer */
+      memcpy(self->prev, self->partial, self->row_size);
+      prev = self->prev;
+    }
+    else {
+      prev = out;
+    }
+    out += self->out_size;
+    n++;
+  }
+
+  /* whole rows, straight from the input */
+  for (; in_len >= self->in_size; in_len -= self->in_size) {
+    if (_predictor_row(self, in, out, prev)) {
+      self->rows += n;
+      *out_len = n * self->out_size;
+      return -1;
+    }
+    prev = self->encode ? in : out;
+    last = prev;
+    in += self->in_size;
+    out += self->out_size;
+    n++;
+  }
+
+  /* carry the previous row. It may be in the caller's buffers */
+  if (last) memcpy(self->prev, last, self->row_size);
+  else if (n && !self->encode) memcpy(self->prev, prev, self->row_size);
+
+  memcpy(self->partial, in, in_len);
+  self->partial_len = in_len;
+
+  self->rows += n;
+  *out_len = n * self->out_size;
+  return 0;
+}
+
+DLLEXPORT void pdf_filt_predictor_done(PdfFiltPredictor *self) {
+  if (self) {
+    free(self->partial);
+    free(self->prev);
+    free(self);
+  }
+}
@@ -33,4 +33,93 @@ pdf_filt_predict_encode(uint8_t *in,
                         uint16_t columns,
                         size_t rows );
 
+// Decode predictors, as above, splitting TIFF predictors into bands of rows
+// that are decoded concurrently by up to 'threads' threads
+DLLEXPORT void
+pdf_filt_predict_decode_mt(uint8_t *in,
+                           uint8_t *out,
+                           uint8_t predictor,
+                           uint8_t colors,
+                           uint8_t bpc,
+                           uint16_t columns,
+                           size_t rows,
+                           int threads );
+
+// Encode predictors, as above, splitting TIFF or PNG predictors into bands
+// of rows that are encoded concurrently by up to 'threads' threads
+DLLEXPORT void
+pdf_filt_predict_encode_mt(uint8_t *in,
+                           uint8_t *out,
+                           uint8_t predictor,
+                           uint8_t colors,
+                           uint8_t bpc,
+                           uint16_t columns,
+                           size_t rows,
+                           int threads );
+
+// Decode TIFF predictors on rows of packed samples, as in a PDF stream,
+// in bands of rows, by up to 'threads' threads
+DLLEXPORT void
+pdf_filt_predict_tiff_decode_packed_mt(uint8_t *in,
+                                       uint8_t *out,
+                                       uint8_t colors,
+                                       uint8_t bpc,
+                                       uint16_t columns,
+                                       size_t rows,
+                                       int threads );
+
+// Encode TIFF predictors on rows of packed samples, as in a PDF stream,
+// in bands of rows, by up to 'threads' threads
+DLLEXPORT void
+pdf_filt_predict_tiff_encode_packed_mt(uint8_t *in,
+                                       uint8_t *out,
+                                       uint8_t colors,
+                                       uint8_t bpc,
+                                       uint16_t columns,
+                                       size_t rows,
+                                       int threads );
+
+/* A streaming predictor. Input is accepted in chunks of any size; whole
+ * rows are decoded, or encoded, as soon as they're complete. Any partial
+ * row, and the previous row, are carried between calls. Rows are packed,
+ * as in a PDF stream, and PNG rows have a leading tag byte. */
+typedef struct {
+  size_t   row_size;     /* decoded row, in bytes */
+  size_t   in_size;      /* input row, in bytes */
+  size_t   out_size;     /* output row, in bytes */
+  uint8_t *partial;      /* input row being assembled */
+  size_t   partial_len;
+  uint8_t *prev;         /* previous decoded row (decoding) or input row (encoding) */
+  uint64_t rows;         /* rows output so far */
+  uint16_t columns;
+  uint8_t  predictor;
+  uint8_t  colors;
+  uint8_t  bpc;
+  uint8_t  bpp;          /* PNG bytes per pixel */
+  uint8_t  encode;
+} PdfFiltPredictor;
+
+// Returns a new decoder, or encoder, or NULL for an unknown predictor
+DLLEXPORT PdfFiltPredictor*
+pdf_filt_predictor_new(uint8_t predictor,
+                       uint8_t colors,
+                       uint8_t bpc,
+                       uint16_t columns,
+                       int encode );
+
+// Room needed in the output buffer, for a further in_len input bytes
+DLLEXPORT size_t pdf_filt_predictor_out_size(PdfFiltPredictor*, size_t in_len);
+
+// Consumes in_len bytes, and writes any completed rows to out, setting
+// *out_len. Returns 0, or -1 on error (a bad PNG tag)
+DLLEXPORT int
+pdf_filt_predictor_put(PdfFiltPredictor*,
+                       uint8_t *in,
+                       size_t in_len,
+                       uint8_t *out,
+                       size_t *out_len );
+
+// Frees the predictor; any partial row is discarded
+DLLEXPORT void pdf_filt_predictor_done(PdfFiltPredictor*);
+
 #endif
@@ -1,8 +1,475 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "pdf.h"
 #include "pdf/filt_predict_png.h"
+#include "pdf/_simd.h"
+
+static int paeth(int left_val, int up_val, int up_left_val) {
+  int p = left_val + up_val - up_left_val;
+  int pa = abs(p - left_val);
+  int pb = abs(p - up_val);
+  int pc = abs(p - up_left_val);
+  return pa <= pb && pa <= pc
+    ? left_val
+    : (pb <= pc ? up_val : up_left_val);
+}
+
+/* scalar reference decoder, for bytes start .. row_size - 1 */
+static int
+_decode_row_scalar(uint8_t tag,
+                   uint8_t *in,
+                   uint8_t *out,
+                   uint8_t *prev,
+                   size_t row_size,
+                   uint8_t bpp,
+                   size_t start
+                   ) {
+  size_t i;
+
+  switch (tag) {
+    case 0: { /* None */
+      for (i = start; i < row_size; i++) {
+        out[i] = in[i];
+      }
+      break;
+    }
+    case 1: { /* Left */
+      for (i = start; i < row_size && i < bpp; i++) {
+        out[i] = in[i];
+      }
+      for (; i < row_size; i++) {
+        out[i] = in[i] + out[i - bpp];
+      }
+      break;
+    }
+    case 2: { /* Up */
+      for (i = start; i < row_size; i++) {
+        uint8_t up_val = prev ? prev[i] : 0;
+        out[i] = in[i] + up_val;
+      }
+      break;
+    }
+    case 3: { /* Average */
+      for (i = start; i < row_size; i++) {
+        uint8_t left_val = i < bpp ? 0 : out[i - bpp];
+        uint8_t up_val = prev ? prev[i] : 0;
+        out[i] = (in[i] + (left_val + up_val) / 2 );
+      }
+      break;
+    }
+    case 4: { /* Paeth */
+      for (i = start; i < row_size; i++) {
+        int left_val = i < bpp ? 0 : out[i - bpp];
+        int up_val = prev ? prev[i] : 0;
+        int up_left_val = prev && i >= bpp ? prev[i - bpp] : 0;
+
+        out[i] = in[i] + paeth(left_val, up_val, up_left_val);
+      }
+      break;
+    }
+    default: {
+      fprintf(stderr, "bad PNG predictor tag: %d\n", tag);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+#ifdef PDF_SSE2
+
+/* Sub, Average and Paeth depend on the previous pixel, so are vectorized
+ * across the bytes of each pixel (2 to 8 bytes), as libpng does. Up has no
+ * such dependency and is vectorized 16, or 32, bytes at a time. Each
+ * function returns the number of bytes decoded; the scalar decoder
+ * finishes the rest of the row. */
+
+/* Pixels are loaded and stored as 4 or 8 bytes, which may overlap the
+ * next pixel. That's safe, as it's written by the next iteration, but
+ * limits the loops to i + _width(bpp) <= row_size. */
+static inline size_t _width(size_t bpp) {
+  return bpp <= 4 ? 4 : 8;
+}
+
+static inline __m128i _load_px(const uint8_t *p, size_t bpp) {
+  if (bpp <= 4) {
+    int32_t v;
+    memcpy(&v, p, 4);
+    return _mm_cvtsi32_si128(v);
+  }
+  return _mm_loadl_epi64((const __m128i*) p);
+}
+
+static inline void _store_px(uint8_t *p, __m128i x, size_t bpp) {
+  if (bpp <= 4) {
+    int32_t v = _mm_cvtsi128_si32(x);
+    memcpy(p, &v, 4);
+  }
+  else {
+    _mm_storel_epi64((__m128i*) p, x);
+  }
+}
+
+static size_t _up_sse2(uint8_t *in, uint8_t *out, uint8_t *prev, size_t row_size) {
+  size_t i;
+  for (i = 0; i + 16 <= row_size; i += 16) {
+    __m128i x = _mm_loadu_si128((const __m128i*) (in + i));
+    __m128i b = _mm_loadu_si128((const __m128i*) (prev + i));
+    _mm_storeu_si128((__m128i*) (out + i), _mm_add_epi8(x, b));
+  }
+  return i;
+}
+
+static inline size_t _sub_sse2(uint8_t *in, uint8_t *out, size_t row_size, size_t bpp) {
+  __m128i a = _mm_setzero_si128();
+  size_t i;
+  for (i = 0; i + _width(bpp) <= row_size; i += bpp) {
+    a = _mm_add_epi8(a, _load_px(in + i, bpp));
+    _store_px(out + i, a, bpp);
+  }
+  return i;
+}
+
+static inline size_t _avg_sse2(uint8_t *in, uint8_t *out, uint8_t *prev, size_t row_size, size_t bpp) {
+  const __m128i one = _mm_set1_epi8(1);
+  __m128i a = _mm_setzero_si128();
+  size_t i;
+  for (i = 0; i + _width(bpp) <= row_size; i += bpp) {
+    __m128i b = _load_px(prev + i, bpp);
+    /* _mm_avg_epu8 rounds up; PNG rounds down */
+    __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+                               _mm_and_si128(_mm_xor_si128(a, b), one));
+    a = _mm_add_epi8(_load_px(in + i, bpp), avg);
+    _store_px(out + i, a, bpp);
+  }
+  return i;
+}
+
+static inline __m128i _abs_epi16(__m128i x) {
+  return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+static inline __m128i _select(__m128i m, __m128i t, __m128i f) {
+  return _mm_or_si128(_mm_and_si128(m, t), _mm_andnot_si128(m, f));
+}
+
+/* branchless Paeth predictor; ties favor a, then b, then c */
+static inline __m128i _paeth_epi16(__m128i a, __m128i b, __m128i c) {
+  __m128i pa = _mm_sub_epi16(b, c);
+  __m128i pb = _mm_sub_epi16(a, c);
+  __m128i pc = _abs_epi16(_mm_add_epi16(pa, pb));
+  __m128i min;
+  pa = _abs_epi16(pa);
+  pb = _abs_epi16(pb);
+  min = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+  return _select(_mm_cmpeq_epi16(min, pa), a,
+                 _select(_mm_cmpeq_epi16(min, pb), b, c));
+}
+
+static inline size_t _paeth_sse2(uint8_t *in, uint8_t *out, uint8_t *prev, size_t row_size, size_t bpp) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i a = zero, c = zero;
+  size_t i;
+  for (i = 0; i + _width(bpp) <= row_size; i += bpp) {
+    /* 16 bit lanes; a: left, b: up, c: up-left */
+    __m128i b = _mm_unpacklo_epi8(_load_px(prev + i, bpp), zero);
+    __m128i x = _mm_unpacklo_epi8(_load_px(in + i, bpp), zero);
+    a = _paeth_epi16(a, b, c);
+    a = _mm_and_si128(_mm_add_epi16(a, x), _mm_set1_epi16(0xFF));
+    _store_px(out + i, _mm_packus_epi16(a, a), bpp);
+    c = b;
+  }
+  return i;
+}
+
+#define PNG_BPP_CASES(fn, ...)                                  \
+  switch (bpp) {                                                \
+    case 2: return fn(__VA_ARGS__, 2);                          \
+    case 3: return fn(__VA_ARGS__, 3);                          \
+    case 4: return fn(__VA_ARGS__, 4);                          \
+    case 5: return fn(__VA_ARGS__, 5);                          \
+    case 6: return fn(__VA_ARGS__, 6);                          \
+    case 7: return fn(__VA_ARGS__, 7);                          \
+    case 8: return fn(__VA_ARGS__, 8);                          \
+    default: return 0;                                          \
+  }
+
+static size_t _sub_simd(uint8_t *in, uint8_t *out, size_t row_size, uint8_t bpp) {
+  PNG_BPP_CASES(_sub_sse2, in, out, row_size)
+}
+
+static size_t _avg_simd(uint8_t *in, uint8_t *out, uint8_t *prev, size_t row_size, uint8_t bpp) {
+  PNG_BPP_CASES(_avg_sse2, in, out, prev, row_size)
+}
+
+static size_t _paeth_simd(uint8_t *in, uint8_t *out, uint8_t *prev, size_t row_size, uint8_t bpp) {
+  PNG_BPP_CASES(_paeth_sse2, in, out, prev, row_size)
+}
+
+#endif
+
+#ifdef PDF_AVX2
+
+PDF_TARGET_AVX2 static size_t _up_avx2(uint8_t *in, uint8_t *out, uint8_t *prev, size_t row_size) {
+  size_t i;
+  for (i = 0; i + 32 <= row_size; i += 32) {
+    __m256i x = _mm256_loadu_si256((const __m256i*) (in + i));
+    __m256i b = _mm256_loadu_si256((const __m256i*) (prev + i));
+    _mm256_storeu_si256((__m256i*) (out + i), _mm256_add_epi8(x, b));
+  }
+  return i + _up_sse2(in + i, out + i, prev + i, row_size - i);
+}
+
+#endif
+
+#ifdef PDF_SSE2
+
+/* decode a leading part of the row; returns the number of bytes done */
+static size_t
+_decode_row_simd(uint8_t tag,
+                 uint8_t *in,
+                 uint8_t *out,
+                 uint8_t *prev,
+                 size_t row_size,
+                 uint8_t bpp
+                 ) {
+  switch (tag) {
+    case 1:
+      return _sub_simd(in, out, row_size, bpp);
+    case 2:
+#ifdef PDF_AVX2
+      if (_have_avx2()) return _up_avx2(in, out, prev, row_size);
+#endif
+      return _up_sse2(in, out, prev, row_size);
+    case 3:
+      return _avg_simd(in, out, prev, row_size, bpp);
+    case 4:
+      return _paeth_simd(in, out, prev, row_size, bpp);
+  }
+  return 0;
+}
+
+#endif
+
+DLLEXPORT int
+pdf_filt_predict_png_decode_row(uint8_t tag,
+                                uint8_t *in,
+                                uint8_t *out,
+                                uint8_t *prev,
+                                size_t row_size,
+                                uint8_t bpp
+                                ) {
+  size_t start = 0;
+#ifdef PDF_SSE2
+  /* the first row, without a previous row, is left to the scalar code */
+  if (prev || tag == 1) {
+    start = _decode_row_simd(tag, in, out, prev, row_size, bpp);
+  }
+#endif
+  return _decode_row_scalar(tag, in, out, prev, row_size, bpp, start);
+}
+
+/* scalar reference encoder, for bytes start .. end - 1 */
+static void
+_encode_row_scalar(uint8_t tag,
+                   uint8_t *in,
+                   uint8_t *out,
+                   uint8_t *prev,
+                   uint8_t bpp,
+                   size_t start,
+                   size_t end
+                   ) {
+  size_t i;
+
+  switch (tag) {
+    case 0: { /* None */
+      for (i = start; i < end; i++) {
+        out[i] = in[i];
+      }
+      break;
+    }
+    case 1: { /* Left */
+      for (i = start; i < end && i < bpp; i++) {
+        out[i] = in[i];
+      }
+      for (; i < end; i++) {
+        out[i] = in[i] - in[i - bpp];
+      }
+      break;
+    }
+    case 2: { /* Up */
+      for (i = start; i < end; i++) {
+        uint8_t up_val = prev ? prev[i] : 0;
+        out[i] = in[i] - up_val;
+      }
+      break;
+    }
+    case 3: { /* Average */
+      for (i = start; i < end; i++) {
+        uint8_t left_val = i < bpp ? 0 : in[i - bpp];
+        uint8_t up_val = prev ? prev[i] : 0;
+        out[i] = (in[i] - (left_val + up_val) / 2 );
+      }
+      break;
+    }
+    case 4: { /* Paeth */
+      for (i = start; i < end; i++) {
+        int left_val = i < bpp ? 0 : in[i - bpp];
+        int up_val = prev ? prev[i] : 0;
+        int up_left_val = prev && i >= bpp ? prev[i - bpp] : 0;
+
+        out[i] = in[i] - paeth(left_val, up_val, up_left_val);
+      }
+      break;
+    }
+  }
+}
+
+/* the magnitude of a residual, taken as a signed byte */
+static uint32_t _residual(uint8_t r) {
+  return r < 128 ? r : 256 - r;
+}
+
+/* accumulate the cost of each tag, for bytes start .. end - 1 */
+static void
+_row_costs_scalar(uint8_t *in,
+                  uint8_t *prev,
+                  uint8_t bpp,
+                  size_t start,
+                  size_t end,
+                  uint64_t *costs
+                  ) {
+  size_t i;
+  for (i = start; i < end; i++) {
+    int x = in[i];
+    int left_val = i < bpp ? 0 : in[i - bpp];
+    int up_val = prev ? prev[i] : 0;
+    int up_left_val = prev && i >= bpp ? prev[i - bpp] : 0;
+
+    costs[0] += _residual(x);
+    costs[1] += _residual(x - left_val);
+    costs[2] += _residual(x - up_val);
+    costs[3] += _residual(x - (left_val + up_val) / 2);
+    costs[4] += _residual(x - paeth(left_val, up_val, up_left_val));
+  }
+}
+
+#ifdef PDF_SSE2
+
+/* Encoding has no dependency on earlier output, so is vectorized 16
+ * bytes at a time, from byte bpp onwards. Each function returns the end
+ * of the bytes done. */
+
+static inline __m128i _paeth_epi8(__m128i a, __m128i b, __m128i c) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i lo = _paeth_epi16(_mm_unpacklo_epi8(a, zero),
+                            _mm_unpacklo_epi8(b, zero),
+                            _mm_unpacklo_epi8(c, zero));
+  __m128i hi = _paeth_epi16(_mm_unpackhi_epi8(a, zero),
+                            _mm_unpackhi_epi8(b, zero),
+                            _mm_unpackhi_epi8(c, zero));
+  return _mm_packus_epi16(lo, hi);
+}
+
+static inline __m128i _avg_epi8(__m128i a, __m128i b) {
+  /* _mm_avg_epu8 rounds up; PNG rounds down */
+  return _mm_sub_epi8(_mm_avg_epu8(a, b),
+                      _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1)));
+}
+
+/* sums of residual magnitudes, in two 64 bit lanes */
+static inline __m128i _residuals(__m128i r) {
+  const __m128i zero = _mm_setzero_si128();
+  return _mm_sad_epu8(_mm_min_epu8(r, _mm_sub_epi8(zero, r)), zero);
+}
+
+static size_t _encode_paeth_sse2(uint8_t *in, uint8_t *out, uint8_t *prev, size_t row_size, uint8_t bpp) {
+  size_t i;
+  for (i = bpp; i + 16 <= row_size; i += 16) {
+    __m128i x = _mm_loadu_si128((const __m128i*) (in + i));
+    __m128i a = _mm_loadu_si128((const __m128i*) (in + i - bpp));
+    __m128i b = _mm_loadu_si128((const __m128i*) (prev + i));
+    __m128i c = _mm_loadu_si128((const __m128i*) (prev + i - bpp));
+    _mm_storeu_si128((__m128i*) (out + i), _mm_sub_epi8(x, _paeth_epi8(a, b, c)));
+  }
+  return i;
+}
+
+static size_t _row_costs_sse2(uint8_t *in, uint8_t *prev, size_t row_size, uint8_t bpp, uint64_t *costs) {
+  __m128i sum[5];
+  uint64_t lanes[2];
+  size_t i;
+  int t;
+  for (t = 0; t < 5; t++) sum[t] = _mm_setzero_si128();
+  for (i = bpp; i + 16 <= row_size; i += 16) {
+    __m128i x = _mm_loadu_si128((const __m128i*) (in + i));
+    __m128i a = _mm_loadu_si128((const __m128i*) (in + i - bpp));
+    __m128i b = _mm_loadu_si128((const __m128i*) (prev + i));
+    __m128i c = _mm_loadu_si128((const __m128i*) (prev + i - bpp));
+    sum[0] = _mm_add_epi64(sum[0], _residuals(x));
+    sum[1] = _mm_add_epi64(sum[1], _residuals(_mm_sub_epi8(x, a)));
+    sum[2] = _mm_add_epi64(sum[2], _residuals(_mm_sub_epi8(x, b)));
+    sum[3] = _mm_add_epi64(sum[3], _residuals(_mm_sub_epi8(x, _avg_epi8(a, b))));
+    sum[4] = _mm_add_epi64(sum[4], _residuals(_mm_sub_epi8(x, _paeth_epi8(a, b, c))));
+  }
+  for (t = 0; t < 5; t++) {
+    _mm_storeu_si128((__m128i*) lanes, sum[t]);
+    costs[t] += lanes[0] + lanes[1];
+  }
+  return i;
+}
+
+#endif
+
+DLLEXPORT void
+pdf_filt_predict_png_encode_row(uint8_t tag,
+                                uint8_t *in,
+                                uint8_t *out,
+                                uint8_t *prev,
+                                size_t row_size,
+                                uint8_t bpp
+                                ) {
+  size_t start = 0;
+#ifdef PDF_SSE2
+  /* other tags are simple enough for the compiler to vectorize */
+  if (tag == 4 && prev && bpp < row_size) {
+    _encode_row_scalar(tag, in, out, prev, bpp, 0, bpp);
+    start = _encode_paeth_sse2(in, out, prev, row_size, bpp);
+  }
+#endif
+  _encode_row_scalar(tag, in, out, prev, bpp, start, row_size);
+}
+
+DLLEXPORT uint8_t
+pdf_filt_predict_png_select_row(uint8_t *in,
+                                uint8_t *prev,
+                                size_t row_size,
+                                uint8_t bpp
+                                ) {
+  uint64_t costs[5] = {0, 0, 0, 0, 0};
+  size_t start = 0;
+  uint8_t tag, best = 0;
+#ifdef PDF_SSE2
+  if (prev && bpp < row_size) {
+    _row_costs_scalar(in, prev, bpp, 0, bpp, costs);
+    start = _row_costs_sse2(in, prev, row_size, bpp, costs);
+  }
+#endif
+  _row_costs_scalar(in, prev, bpp, start, row_size, costs);
+
+  for (tag = 1; tag < 5; tag++) {
+    if (costs[tag] < costs[best]) best = tag;
+  }
+  return best;
+}
+
+DLLEXPORT uint8_t
+pdf_filt_predict_png_bpp(uint8_t colors, uint8_t bpc) {
+  size_t bpp = ((size_t) colors * bpc + 7) / 8;
+  return bpp > 255 ? 255 : (uint8_t) bpp;
+}
+
 DLLEXPORT void
 pdf_filt_predict_png_decode(uint8_t *buf,
                             uint8_t *out,
@@ -11,153 +478,68 @@ pdf_filt_predict_png_decode(uint8_t *buf,
                             uint16_t columns,
                             size_t rows
                             ) {
-  int row_size = (colors * bpc * columns + 7) / 8;
-  int idx = 0;
-  int n = 0;
+  size_t row_size = (colors * bpc * columns + 7) / 8;
+  uint8_t bpp = pdf_filt_predict_png_bpp(colors, bpc);
+  uint8_t *prev = NULL;
   size_t row;
 
   for (row = 0; row < rows; row++) {
     /* PNG prediction can vary from row to row */
-    uint8_t tag = buf[idx++];
-    int i;
-
-    switch (tag) {
-      case 0: { /* None */
-        for (i = 0; i < row_size; i++) {
-          out[n++] = buf[idx++];
-        }
-        break;
-      }
-      case 1: { /* Left */
-        for (i = 0; i < colors; i++) {
-          out[n++] = buf[idx++];
-        }
-        for (i = colors+1; i <= row_size; i++) {
-          uint8_t left_val = out[n - colors];
-          out[n++] = buf[idx++] + left_val;
-        }
-        break;
-      }
-      case 2: { /* Up */
-        for (i = 0; i < row_size; i++) {
-          uint8_t up_val = row ? out[n - row_size] : 0;
-          out[n++] = buf[idx++] + up_val;
-        }
-        break;
-      }
-      case 3: { /* Average */
-        for (i = 0; i < row_size; i++) {
-          uint8_t left_val = i < colors ? 0 : out[n - colors];
-          uint8_t up_val = row ? out[n - row_size] : 0;
-          out[n++] = (buf[idx++] + (left_val + up_val) / 2 );
-          }
-        break;
-      }
-      case 4: { /* Paeth */
-        for (i = 0; i < row_size; i++) {
-          int left_val = i < colors ? 0 : out[n - colors];
-          int up_val = row ? out[n - row_size] : 0;
-          int up_left_val = row && i >= colors ? out[n - colors - row_size] : 0;
-
-          int p = left_val + up_val - up_left_val;
-          int pa = abs(p - left_val);
-          int pb = abs(p - up_val);
-          int pc = abs(p - up_left_val);
-          int nearest =  pa <= pb && pa <= pc
-            ? left_val
-            : (pb <= pc ? up_val : up_left_val);
-
-          out[n++] = buf[idx++] + nearest;
-        }
-        break;
-      }
-    default: {
-        fprintf(stderr, "bad PNG predictor tag: %d\n", tag);
-      }
-    }
+    uint8_t tag = *buf++;
+    pdf_filt_predict_png_decode_row(tag, buf, out, prev, row_size, bpp);
+    prev = out;
+    buf += row_size;
+    out += row_size;
   }
 }
 
-DLLEXPORT void pdf_filt_predict_png_encode(uint8_t *buf,
-                                           uint8_t *out,
-                                           uint8_t colors,
-                                           uint8_t bpc,
-                                           uint16_t columns,
-                                           size_t rows,
-                                           uint8_t tag
-                                           ) {
-  int row_size = (colors * bpc * columns + 7) / 8;
-  int idx = 0;
-  int n = 0;
+DLLEXPORT void
+pdf_filt_predict_png_encode_band(uint8_t *buf,
+                                 uint8_t *out,
+                                 uint8_t *prev,
+                                 uint8_t colors,
+                                 uint8_t bpc,
+                                 uint16_t columns,
+                                 size_t rows,
+                                 uint8_t tag
+                                 ) {
+  size_t row_size = (colors * bpc * columns + 7) / 8;
+  uint8_t bpp = pdf_filt_predict_png_bpp(colors, bpc);
   size_t row;
 
-  if (tag == 15) {
-    /* optimize - just use Paeth */
-    tag = 4;
+  int optimum = tag == 15;
+
+  if (optimum) {
+    /* chosen per row */
+    tag = 0;
   }
   else if (tag >= 10 && tag <= 14) {
       tag -= 10;
   }
-  if (tag > 5) {
+  if (tag > 4) {
     fprintf(stderr, __FILE__ ":bad PNG predictor tag: %d\n", tag);
     return;
   }
 
   for (row = 0; row < rows; row++) {
-    int i;
-
-    out[n++] = tag;
-
-    switch (tag) {
-      case 0: { /* None */
-        for (i = 0; i < row_size; i++) {
-          out[n++] = buf[idx++];
-        }
-        break;
-      }
-      case 1: { /* Left */
-        for (i = 0; i < colors; i++) {
-          out[n++] = buf[idx++];
-        }
-        for (i = colors+1; i <= row_size; i++) {
-          uint8_t left_val = buf[idx - colors];
-          out[n++] = buf[idx++] - left_val;
-        }
-        break;
-      }
-      case 2: { /* Up */
-        for (i = 0; i < row_size; i++) {
-          uint8_t up_val = row ? buf[idx - row_size] : 0;
-          out[n++] = buf[idx++] - up_val;
-        }
-        break;
-      }
-      case 3: { /* Average */
-        for (i = 0; i < row_size; i++) {
-          uint8_t left_val = i < colors ? 0 : buf[idx - colors];
-          uint8_t up_val = row ? buf[idx - row_size] : 0;
-          out[n++] = (buf[idx++] - (left_val + up_val) / 2 );
-        }
-        break;
-      }
-    case 4: { /* Paeth */
-        for (i = 0; i < row_size; i++) {
-          int left_val = i < colors ? 0 : buf[idx - colors];
-          int up_val = row ? buf[idx - row_size] : 0;
-          int up_left_val = row && i >= colors ? buf[idx - colors - row_size] : 0;
-
-          int p = left_val + up_val - up_left_val;
-          int pa = abs(p - left_val);
-          int pb = abs(p - up_val);
-          int pc = abs(p - up_left_val);
-          int nearest =  pa <= pb && pa <= pc
-            ? left_val
-            : (pb <= pc ? up_val : up_left_val);
-
-          out[n++] = buf[idx++] - nearest;
-        }
-        break;
-      }
+    if (optimum) {
+      tag = pdf_filt_predict_png_select_row(buf, prev, row_size, bpp);
     }
+    *out++ = tag;
+    pdf_filt_predict_png_encode_row(tag, buf, out, prev, row_size, bpp);
+    prev = buf;
+    buf += row_size;
+    out += row_size;
   }
 }
+
+DLLEXPORT void pdf_filt_predict_png_encode(uint8_t *buf,
+                                           uint8_t *out,
+                                           uint8_t colors,
+                                           uint8_t bpc,
+                                           uint16_t columns,
+                                           size_t rows,
+                                           uint8_t tag
+                                           ) {
+  pdf_filt_predict_png_encode_band(buf, out, NULL, colors, bpc, columns, rows, tag);
+}
@@ -1,6 +1,41 @@
 #ifndef PDF_FILT_PREDICT_PNG_H_
 #define PDF_FILT_PREDICT_PNG_H_
 
+// Decode a single PNG row, given the previous decoded row, or NULL.
+// Returns 0, or -1 for an unknown tag
+DLLEXPORT int
+pdf_filt_predict_png_decode_row(uint8_t tag,
+                                uint8_t *in,
+                                uint8_t *out,
+                                uint8_t *prev,
+                                size_t row_size,
+                                uint8_t bpp
+                                );
+
+// Encode a single PNG row, given the previous input row, or NULL.
+// The tag byte is not written
+DLLEXPORT void
+pdf_filt_predict_png_encode_row(uint8_t tag,
+                                uint8_t *in,
+                                uint8_t *out,
+                                uint8_t *prev,
+                                size_t row_size,
+                                uint8_t bpp
+                                );
+
+// Choose a tag (0 - 4) for a single PNG row, given the previous input row,
+// or NULL, by the minimum sum of absolute differences
+DLLEXPORT uint8_t
+pdf_filt_predict_png_select_row(uint8_t *in,
+                                uint8_t *prev,
+                                size_t row_size,
+                                uint8_t bpp
+                                );
+
+// Bytes per complete pixel, rounded up to a whole byte, as used by the
+// row functions above
+DLLEXPORT uint8_t pdf_filt_predict_png_bpp(uint8_t colors, uint8_t bpc);
+
 // Decode PNG predictors
 DLLEXPORT void
 pdf_filt_predict_png_decode(uint8_t *buf,
@@ -11,6 +46,18 @@ pdf_filt_predict_png_decode(uint8_t *buf,
                             size_t rows
                             );
 
+// Encode a band of rows, given the input row before the band, or NULL
+DLLEXPORT void
+pdf_filt_predict_png_encode_band(uint8_t *buf,
+                                 uint8_t *out,
+                                 uint8_t *prev,
+                                 uint8_t colors,
+                                 uint8_t bpc,
+                                 uint16_t columns,
+                                 size_t rows,
+                                 uint8_t predictor
+                                 );
+
 // Encode PNG predictors
 DLLEXPORT void
 pdf_filt_predict_png_encode(uint8_t *buf,
@@ -1,7 +1,275 @@
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 #include "pdf.h"
 #include "pdf/filt_predict_tiff.h"
+
+/* Single rows of packed samples, as found in the PDF stream. Multi-byte
+ * samples are big-endian. Rows are padded to a whole number of bytes */
+
+static uint32_t get_sample(uint8_t* row, size_t i, uint8_t bpc) {
+  switch (bpc) {
+  case 8:
+    return row[i];
+  case 16:
+    row += 2*i;
+    return (row[0] << 8) | row[1];
+  case 32:
+    row += 4*i;
+    return ((uint32_t)row[0] << 24) | (row[1] << 16) | (row[2] << 8) | row[3];
+  default: {
+    size_t bit = i * bpc;
+    uint8_t shift = 8 - bpc - (bit % 8);
+    return (row[bit / 8] >> shift) & ((1 << bpc) - 1);
+  }
+  }
+}
+
+static void set_sample(uint8_t* row, size_t i, uint8_t bpc, uint32_t v) {
+  switch (bpc) {
+  case 8:
+    row[i] = v;
+    break;
+  case 16:
+    row += 2*i;
+    row[0] = v >> 8;
+    row[1] = v;
+    break;
+  case 32:
+    row += 4*i;
+    row[0] = v >> 24;
+    row[1] = v >> 16;
+    row[2] = v >> 8;
+    row[3] = v;
+    break;
+  default: {
+    size_t bit = i * bpc;
+    uint8_t shift = 8 - bpc - (bit % 8);
+    uint8_t mask = ((1 << bpc) - 1) << shift;
+    row[bit / 8] = (row[bit / 8] & ~mask) | ((v << shift) & mask);
+  }
+  }
+}
+
+/* SWAR (SIMD within a register) arithmetic. Rows are processed as words
+ * of w bits: the largest multiple of the pixel size, in whole bytes, up to
+ * 64 bits. Each word is loaded big-endian, into the low w bits of a
+ * uint64_t, and worked on as bpc-bit lanes. */
+
+static inline uint64_t _load_be(const uint8_t *p, size_t n) {
+  uint64_t v = 0;
+  size_t i;
+  if (n == 8) {
+    return ((uint64_t) p[0] << 56) | ((uint64_t) p[1] << 48)
+      | ((uint64_t) p[2] << 40) | ((uint64_t) p[3] << 32)
+      | ((uint64_t) p[4] << 24) | ((uint64_t) p[5] << 16)
+      | ((uint64_t) p[6] << 8) | (uint64_t) p[7];
+  }
+  for (i = 0; i < n; i++) v = (v << 8) | p[i];
+  return v;
+}
+
+static inline void _store_be(uint8_t *p, size_t n, uint64_t v) {
+  while (n--) {
+    p[n] = v;
+    v >>= 8;
+  }
+}
+
+/* word size, in bits, for s-bit pixels; 0 if too large */
+static unsigned _word_bits(unsigned s) {
+  unsigned l = s;
+  if (s == 0 || s > 64) return 0;
+  while (l % 8) l += s;
+  return l > 64 ? 0 : (64 / l) * l;
+}
+
+/* the top bit of each lane */
+static uint64_t _lane_high(uint8_t bpc) {
+  uint64_t h = 0;
+  unsigned i;
+  for (i = bpc - 1; i < 64; i += bpc) h |= (uint64_t) 1 << i;
+  return h;
+}
+
+/* lane-wise addition and subtraction, modulo 2^bpc */
+static inline uint64_t _lane_add(uint64_t x, uint64_t y, uint64_t h) {
+  return ((x & ~h) + (y & ~h)) ^ ((x ^ y) & h);
+}
+
+static inline uint64_t _lane_sub(uint64_t x, uint64_t y, uint64_t h) {
+  return ((x | h) - (y & ~h)) ^ ((x ^ ~y) & h);
+}
+
+static inline uint64_t _low_bits(unsigned n) {
+  return n >= 64 ? ~(uint64_t) 0 : ((uint64_t) 1 << n) - 1;
+}
+
+/* Decoding is a prefix sum across the s-bit pixels in each word, plus the
+ * last pixel of the previous word. The final word may be partial. */
+static void _decode_swar(uint8_t *in, uint8_t *out, size_t n, unsigned s, unsigned w, uint8_t bpc) {
+  uint64_t h = _lane_high(bpc);
+  uint64_t rep = 0, carry = 0;
+  size_t bytes = w / 8;
+  size_t i;
+  unsigned k;
+
+  for (k = 0; k < w; k += s) rep |= (uint64_t) 1 << k;
+
+  for (i = 0; i < n; i += bytes) {
+    size_t len = n - i < bytes ? n - i : bytes;
+    uint64_t x = _load_be(in + i, len) << (8 * (bytes - len));
+    for (k = s; k < w; k <<= 1) x = _lane_add(x, x >> k, h);
+    x = _lane_add(x, carry, h);
+    _store_be(out + i, len, x >> (8 * (bytes - len)));
+    carry = (x & _low_bits(s)) * rep;
+  }
+}
+
+/* Encoding subtracts each word, shifted by a pixel, with the last pixel
+ * of the previous input word shifted in */
+static void _encode_swar(uint8_t *in, uint8_t *out, size_t n, unsigned s, unsigned w, uint8_t bpc) {
+  uint64_t h = _lane_high(bpc);
+  uint64_t mask = _low_bits(w);
+  uint64_t prev = 0;
+  size_t bytes = w / 8;
+  size_t i;
+
+  for (i = 0; i < n; i += bytes) {
+    size_t len = n - i < bytes ? n - i : bytes;
+    uint64_t x = _load_be(in + i, len) << (8 * (bytes - len));
+    uint64_t y = s == w ? prev : ((x >> s) | (prev << (w - s))) & mask;
+    _store_be(out + i, len, _lane_sub(x, y, h) >> (8 * (bytes - len)));
+    prev = x;
+  }
+}
+
+static int _check_bpc(uint8_t bpc) {
+  switch (bpc) {
+  case 1: case 2: case 4: case 8: case 16: case 32:
+    return 0;
+  default:
+    fprintf(stderr, "%s: unhandled TIFF bpc: %d\n", __FILE__, bpc);
+    return -1;
+  }
+}
+
+/* copy back padding bits, at the end of the row */
+static void _keep_padding(uint8_t *in, uint8_t *out, size_t bits) {
+  if (bits % 8) {
+    size_t last = bits / 8;
+    uint8_t pad = 0xFF >> (bits % 8);
+    out[last] = (out[last] & ~pad) | (in[last] & pad);
+  }
+}
+
+DLLEXPORT int
+pdf_filt_predict_tiff_decode_row(uint8_t *in,
+                                 uint8_t *out,
+                                 uint8_t colors,
+                                 uint8_t bpc,
+                                 uint16_t columns
+                                 ) {
+  size_t samples = (size_t) colors * columns;
+  size_t bits = samples * bpc;
+  unsigned s = (unsigned) colors * bpc;
+  unsigned w;
+  size_t i;
+
+  if (_check_bpc(bpc)) return -1;
+  if (samples == 0) return 0;
+  w = _word_bits(s);
+
+  if (bpc == 8 && 64 % s) {
+    /* faster a byte at a time, than as words of whole pixels */
+    for (i = 0; i < colors && i < samples; i++) out[i] = in[i];
+    for (; i < samples; i++) out[i] = in[i] + out[i - colors];
+  }
+  else if (w) {
+    _decode_swar(in, out, (bits + 7) / 8, s, w, bpc);
+    _keep_padding(in, out, bits);
+  }
+  else {
+    /* also copies any padding bits */
+    memcpy(out, in, (bits + 7) / 8);
+
+    for (i = colors; i < samples; i++) {
+      set_sample(out, i, bpc, get_sample(in, i, bpc) + get_sample(out, i - colors, bpc));
+    }
+  }
+  return 0;
+}
+
+DLLEXPORT int
+pdf_filt_predict_tiff_encode_row(uint8_t *in,
+                                 uint8_t *out,
+                                 uint8_t colors,
+                                 uint8_t bpc,
+                                 uint16_t columns
+                                 ) {
+  size_t samples = (size_t) colors * columns;
+  size_t bits = samples * bpc;
+  unsigned s = (unsigned) colors * bpc;
+  unsigned w;
+  size_t i;
+
+  if (_check_bpc(bpc)) return -1;
+  if (samples == 0) return 0;
+  w = _word_bits(s);
+
+  if (bpc == 8 && 64 % s) {
+    /* faster a byte at a time, than as words of whole pixels */
+    for (i = 0; i < colors && i < samples; i++) out[i] = in[i];
+    for (; i < samples; i++) out[i] = in[i] - in[i - colors];
+  }
+  else if (w) {
+    _encode_swar(in, out, (bits + 7) / 8, s, w, bpc);
+    _keep_padding(in, out, bits);
+  }
+  else {
+    memcpy(out, in, (bits + 7) / 8);
+
+    for (i = colors; i < samples; i++) {
+      set_sample(out, i, bpc, get_sample(in, i, bpc) - get_sample(in, i - colors, bpc));
+    }
+  }
+  return 0;
+}
+
+DLLEXPORT void
+pdf_filt_predict_tiff_decode_packed(uint8_t *in,
+                                    uint8_t *out,
+                                    uint8_t colors,
+                                    uint8_t bpc,
+                                    uint16_t columns,
+                                    size_t rows
+                                    ) {
+  size_t row_size = ((size_t) colors * bpc * columns + 7) / 8;
+  size_t r;
+  for (r = 0; r < rows; r++) {
+    if (pdf_filt_predict_tiff_decode_row(in, out, colors, bpc, columns)) break;
+    in += row_size;
+    out += row_size;
+  }
+}
+
+DLLEXPORT void
+pdf_filt_predict_tiff_encode_packed(uint8_t *in,
+                                    uint8_t *out,
+                                    uint8_t colors,
+                                    uint8_t bpc,
+                                    uint16_t columns,
+                                    size_t rows
+                                    ) {
+  size_t row_size = ((size_t) colors * bpc * columns + 7) / 8;
+  size_t r;
+  for (r = 0; r < rows; r++) {
+    if (pdf_filt_predict_tiff_encode_row(in, out, colors, bpc, columns)) break;
+    in += row_size;
+    out += row_size;
+  }
+}
+
 /* Decoding */
 
 static void tiff_decode_nibble (uint8_t* in,
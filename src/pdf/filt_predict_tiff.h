@@ -1,7 +1,47 @@
 #ifndef PDF_FILT_PREDICT_TIFF_H_
 #define PDF_FILT_PREDICT_TIFF_H_
 
-// Decode TIFF predictors
+// Decode a single row of packed, big-endian, samples. Returns 0, or -1 for
+// an unsupported bpc
+DLLEXPORT int
+pdf_filt_predict_tiff_decode_row(uint8_t *in,
+                                 uint8_t *out,
+                                 uint8_t colors,
+                                 uint8_t bpc,
+                                 uint16_t columns
+                                 );
+
+// Encode a single row of packed, big-endian, samples. Returns 0, or -1 for
+// an unsupported bpc
+DLLEXPORT int
+pdf_filt_predict_tiff_encode_row(uint8_t *in,
+                                 uint8_t *out,
+                                 uint8_t colors,
+                                 uint8_t bpc,
+                                 uint16_t columns
+                                 );
+
+// Decode TIFF predictors, on rows of packed samples
+DLLEXPORT void
+pdf_filt_predict_tiff_decode_packed(uint8_t *in,
+                                    uint8_t *out,
+                                    uint8_t colors,
+                                    uint8_t bpc,
+                                    uint16_t columns,
+                                    size_t rows
+                                    );
+
+// Encode TIFF predictors, on rows of packed samples
+DLLEXPORT void
+pdf_filt_predict_tiff_encode_packed(uint8_t *in,
+                                    uint8_t *out,
+                                    uint8_t colors,
+                                    uint8_t bpc,
+                                    uint16_t columns,
+                                    size_t rows
+                                    );
+
+// Decode TIFF predictors, on unpacked samples
 DLLEXPORT void
 pdf_filt_predict_tiff_decode(uint8_t *in,
                                uint8_t *out,
@@ -11,7 +51,7 @@ pdf_filt_predict_tiff_decode(uint8_t *in,
                                size_t rows
                                );
 
-// Encode TIFF predictors
+// Encode TIFF predictors, on unpacked samples
 DLLEXPORT void
 pdf_filt_predict_tiff_encode(uint8_t *in,
                              uint8_t *out,
@@ -0,0 +1,210 @@
+/* RunLengthDecode and RunLengthEncode.
+ *
+ * A length byte n of 0 to 127 is followed by n + 1 literal bytes; 129 to
+ * 255 is followed by one byte, repeated 257 - n times; 128 ends the data.
+ * Runs and literals may span chunks of input.
+ *
+ * The encoder writes runs of three or more bytes as repeats; shorter runs
+ * are merged into the surrounding literals.
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pdf.h"
+#include "pdf/filt_runlength.h"
+#include "pdf/_outbuf.h"
+
+#define PDF_RL_EOD 128
+#define PDF_RL_MAX 128
+#define PDF_RL_MIN_RUN 3
+
+struct PdfFiltRunLength {
+  _OutBuf  out;                 /* output from the last call */
+  unsigned literal;             /* decoding: literal bytes still to copy */
+  unsigned repeat;              /* decoding: a repeat, waiting for its byte */
+  unsigned run;                 /* encoding: length of the current run */
+  unsigned pending;             /* encoding: literal bytes, not yet written */
+  uint8_t  run_byte;
+  uint8_t  encode;
+  uint8_t  eod;
+  uint8_t  literals[PDF_RL_MAX];
+};
+
+static int _decode(PdfFiltRunLength *self, uint8_t *in, size_t in_len) {
+  _OutBuf *ob = &self->out;
+  uint8_t *end = in + in_len;
+
+  if (self->eod) return 0;
+
+  while (in < end) {
+    if (self->literal) {
+      size_t n = self->literal;
+      if (n > (size_t) (end - in)) n = end - in;
+      if (_reserve(ob, n)) return -1;
+      memcpy(ob->buf + ob->len, in, n);
+      ob->len += n;
+      in += n;
+      self->literal -= n;
+    }
+    else if (self->repeat) {
+      if (_reserve(ob, self->repeat)) return -1;
+      memset(ob->buf + ob->len, *in++, self->repeat);
+      ob->len += self->repeat;
+      self->repeat = 0;
+    }
+    else {
+      uint8_t n = *in++;
+      if (n < PDF_RL_EOD) {
+        self->literal = n + 1;
+      }
+      else if (n > PDF_RL_EOD) {
+        self->repeat = 257 - n;
+      }
+      else {
+        self->eod = 1;
+        break;
+      }
+    }
+  }
+  return 0;
+}
+
+static void _flush_literals(PdfFiltRunLength *self, _OutBuf *ob) {
+  if (self->pending) {
+    ob->buf[ob->len++] = self->pending - 1;
+    memcpy(ob->buf + ob->len, self->literals, self->pending);
+    ob->len += self->pending;
+    self->pending = 0;
+  }
+}
+
+static void _end_run(PdfFiltRunLength *self, _OutBuf *ob) {
+  if (self->run >= PDF_RL_MIN_RUN) {
+    _flush_literals(self, ob);
+    ob->buf[ob->len++] = 257 - self->run;
+    ob->buf[ob->len++] = self->run_byte;
+  }
+  else {
+    unsigned i;
+    for (i = 0; i < self->run; i++) {
+      self->literals[self->pending++] = self->run_byte;
+      if (self->pending == PDF_RL_MAX) _flush_literals(self, ob);
+    }
+  }
+  self->run = 0;
+}
+
+static int _encode(PdfFiltRunLength *self, uint8_t *in, size_t in_len) {
+  _OutBuf *ob = &self->out;
+  uint8_t *end = in + in_len;
+
+  /* at most one length byte per 128 bytes, plus what's pending */
+  if (_reserve(ob, in_len + in_len / PDF_RL_MAX + 2 * PDF_RL_MAX + 4)) return -1;
+
+  while (in < end) {
+    if (self->run && *in == self->run_byte && self->run < PDF_RL_MAX) {
+      /* extend the run */
+      uint8_t *p = in;
+      size_t room = PDF_RL_MAX - self->run;
+      if (room > (size_t) (end - in)) room = end - in;
+      while ((size_t) (p - in) < room && *p == self->run_byte) p++;
+      self->run += p - in;
+      in = p;
+    }
+    else {
+      _end_run(self, ob);
+      self->run_byte = *in++;
+      self->run = 1;
+    }
+  }
+  return 0;
+}
+
+static int _finish(PdfFiltRunLength *self) {
+  if (self->eod) return 0;
+  if (self->encode) {
+    _OutBuf *ob = &self->out;
+    if (_reserve(ob, 2 * PDF_RL_MAX + 4)) return -1;
+    _end_run(self, ob);
+    _flush_literals(self, ob);
+    ob->buf[ob->len++] = PDF_RL_EOD;
+  }
+  self->eod = 1;
+  return 0;
+}
+
+DLLEXPORT PdfFiltRunLength* pdf_filt_runlength_new(int encode) {
+  PdfFiltRunLength *self = calloc(1, sizeof(PdfFiltRunLength));
+  if (self == NULL) return NULL;
+  self->encode = encode ? 1 : 0;
+  return self;
+}
+
+DLLEXPORT int
+pdf_filt_runlength_put(PdfFiltRunLength *self,
+                       uint8_t *in,
+                       size_t in_len,
+                       uint8_t **out,
+                       size_t *out_len
+                       ) {
+  int rc;
+  if (self->encode && self->eod) return -1;
+  self->out.len = 0;
+  rc = self->encode ? _encode(self, in, in_len) : _decode(self, in, in_len);
+  *out = self->out.buf;
+  *out_len = rc ? 0 : self->out.len;
+  return rc;
+}
+
+DLLEXPORT int pdf_filt_runlength_finish(PdfFiltRunLength *self, uint8_t **out, size_t *out_len) {
+  int rc;
+  self->out.len = 0;
+  rc = _finish(self);
+  *out = self->out.buf;
+  *out_len = rc ? 0 : self->out.len;
+  return rc;
+}
+
+DLLEXPORT void pdf_filt_runlength_done(PdfFiltRunLength *self) {
+  if (self) {
+    free(self->out.buf);
+    free(self);
+  }
+}
+
+/* one-shot: the whole input, then hand over the output buffer */
+static int _run(uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len, int encode) {
+  PdfFiltRunLength *self = pdf_filt_runlength_new(encode);
+  int rc = -1;
+
+  *out = NULL;
+  *out_len = 0;
+
+  if (self == NULL) return -1;
+
+  if ((encode ? _encode(self, in, in_len) : _decode(self, in, in_len)) == 0
+      && _finish(self) == 0) {
+    *out = self->out.buf;
+    *out_len = self->out.len;
+    self->out.buf = NULL;
+    rc = 0;
+  }
+
+  pdf_filt_runlength_done(self);
+  return rc;
+}
+
+DLLEXPORT int pdf_filt_runlength_decode(uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len) {
+  return _run(in, in_len, out, out_len, 0);
+}
+
+DLLEXPORT int pdf_filt_runlength_encode(uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len) {
+  return _run(in, in_len, out, out_len, 1);
+}
+
+DLLEXPORT void pdf_filt_runlength_free(uint8_t *buf) {
+  free(buf);
+}
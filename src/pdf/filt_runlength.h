@@ -0,0 +1,30 @@
+#ifndef PDF_FILT_RUNLENGTH_H_
+#define PDF_FILT_RUNLENGTH_H_
+
+/* A streaming RunLength decoder, or encoder; opaque */
+typedef struct PdfFiltRunLength PdfFiltRunLength;
+
+DLLEXPORT PdfFiltRunLength* pdf_filt_runlength_new(int encode);
+
+// Consumes in_len bytes. Sets *out to any output, which remains owned by
+// the decoder and is valid until the next call. Returns 0, or -1 on error
+DLLEXPORT int
+pdf_filt_runlength_put(PdfFiltRunLength*,
+                       uint8_t *in,
+                       size_t in_len,
+                       uint8_t **out,
+                       size_t *out_len
+                       );
+
+// Ends the stream. An encoder writes any pending run and the EOD byte, 128
+DLLEXPORT int pdf_filt_runlength_finish(PdfFiltRunLength*, uint8_t **out, size_t *out_len);
+
+DLLEXPORT void pdf_filt_runlength_done(PdfFiltRunLength*);
+
+// Returns 0 and sets *out, to be freed by pdf_filt_runlength_free(), or -1
+DLLEXPORT int pdf_filt_runlength_decode(uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len);
+DLLEXPORT int pdf_filt_runlength_encode(uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len);
+
+DLLEXPORT void pdf_filt_runlength_free(uint8_t *);
+
+#endif
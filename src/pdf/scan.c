@@ -0,0 +1,243 @@
+/*
+ * scan.c:
+ *
+ * Character classification and run scanning for the tokenizer.
+ *
+ * The pdf_scan_*() functions measure runs of whitespace or regular
+ * characters, or search for line endings and keywords. They use SSE2, or AVX2 when
+ * the CPU supports it (detected at runtime), and a scalar loop otherwise,
+ * or when compiled with -DPDF_NO_SIMD.
+ */
+
+#include "pdf.h"
+#include "pdf/scan.h"
+#include "pdf/_simd.h"
+#include <string.h>
+
+const uint8_t pdf_char_class[256] = {
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x41, 0x01, 0x01, 0x41, 0x00, 0x00, /* 00-0F */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* 10-1F */
+    0x01, 0x30, 0x30, 0x30, 0x30, 0x14, 0x30, 0x30, 0x14, 0x14, 0x30, 0x30, 0x30, 0x30, 0x30, 0x14, /* 20-2F */
+    0x38, 0x38, 0x38, 0x38, 0x38, 0x38, 0x38, 0x38, 0x38, 0x38, 0x30, 0x30, 0x14, 0x30, 0x14, 0x30, /* 30-3F */
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, /* 40-4F */
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x14, 0x30, 0x14, 0x30, 0x30, /* 50-5F */
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, /* 60-6F */
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x14, 0x30, 0x14, 0x30, 0x00, /* 70-7F */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* 80-8F */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* 90-9F */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* A0-AF */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* B0-BF */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* C0-CF */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* D0-DF */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* E0-EF */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* F0-FF */
+};
+
+/* scalar scans; also used for short runs and tails */
+#define SCAN_PREFIX 8
+
+static size_t _scan_space_scalar(const char* p, size_t n, size_t i) {
+    while (i < n && PDF_CC(p[i], PDF_CC_SPACE|PDF_CC_NUL)) i++;
+    return i;
+}
+
+static size_t _scan_regular_scalar(const char* p, size_t n, size_t i) {
+    while (i < n && PDF_CC(p[i], PDF_CC_REGULAR)) i++;
+    return i;
+}
+
+static size_t _scan_eol_scalar(const char* p, size_t n, size_t i) {
+    while (i < n && !PDF_CC(p[i], PDF_CC_EOL)) i++;
+    return i;
+}
+
+#ifdef PDF_SSE2
+
+/* NUL, SP and HT .. CR; the latter as an unsigned range check: (x - 9) <= 4 */
+static __m128i _space_mask16(__m128i x) {
+    __m128i r = _mm_sub_epi8(x, _mm_set1_epi8(9));
+    __m128i m = _mm_cmpeq_epi8(_mm_max_epu8(r, _mm_set1_epi8(4)), _mm_set1_epi8(4));
+    m = _mm_or_si128(m, _mm_cmpeq_epi8(x, _mm_set1_epi8(' ')));
+    return _mm_or_si128(m, _mm_cmpeq_epi8(x, _mm_setzero_si128()));
+}
+
+/* '!' .. '~', less delimiters. Folding bits pairs up '(' ')', '<' '>',
+   '[' '{' and ']' '}' */
+static __m128i _regular_mask16(__m128i x) {
+    __m128i r = _mm_sub_epi8(x, _mm_set1_epi8('!'));
+    __m128i m = _mm_cmpeq_epi8(_mm_max_epu8(r, _mm_set1_epi8('~' - '!')), _mm_set1_epi8('~' - '!'));
+    __m128i d = _mm_cmpeq_epi8(_mm_or_si128(x, _mm_set1_epi8(0x01)), _mm_set1_epi8(')'));
+    d = _mm_or_si128(d, _mm_cmpeq_epi8(_mm_or_si128(x, _mm_set1_epi8(0x02)), _mm_set1_epi8('>')));
+    d = _mm_or_si128(d, _mm_cmpeq_epi8(_mm_or_si128(x, _mm_set1_epi8(0x20)), _mm_set1_epi8('{')));
+    d = _mm_or_si128(d, _mm_cmpeq_epi8(_mm_or_si128(x, _mm_set1_epi8(0x20)), _mm_set1_epi8('}')));
+    d = _mm_or_si128(d, _mm_cmpeq_epi8(x, _mm_set1_epi8('/')));
+    d = _mm_or_si128(d, _mm_cmpeq_epi8(x, _mm_set1_epi8('%')));
+    return _mm_andnot_si128(d, m);
+}
+
+static __m128i _eol_mask16(__m128i x) {
+    return _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('\n')),
+                        _mm_cmpeq_epi8(x, _mm_set1_epi8('\r')));
+}
+
+#define SCAN_SPAN16(name, mask_fn, scalar_fn)                           \
+    static size_t name(const char* p, size_t n, size_t i) {             \
+        for (; i + 16 <= n; i += 16) {                                  \
+            uint32_t m = _mm_movemask_epi8(mask_fn(_mm_loadu_si128((const __m128i*)(p + i)))); \
+            if (m != 0xFFFF) return i + _ctz(~m);                       \
+        }                                                               \
+        return scalar_fn(p, n, i);                                      \
+    }
+
+SCAN_SPAN16(_scan_space_sse2, _space_mask16, _scan_space_scalar)
+SCAN_SPAN16(_scan_regular_sse2, _regular_mask16, _scan_regular_scalar)
+
+static size_t _scan_eol_sse2(const char* p, size_t n, size_t i) {
+    for (; i + 16 <= n; i += 16) {
+        uint32_t m = _mm_movemask_epi8(_eol_mask16(_mm_loadu_si128((const __m128i*)(p + i))));
+        if (m) return i + _ctz(m);
+    }
+    return _scan_eol_scalar(p, n, i);
+}
+
+#endif
+
+#ifdef PDF_AVX2
+
+PDF_TARGET_AVX2 static __m256i _space_mask32(__m256i x) {
+    __m256i r = _mm256_sub_epi8(x, _mm256_set1_epi8(9));
+    __m256i m = _mm256_cmpeq_epi8(_mm256_max_epu8(r, _mm256_set1_epi8(4)), _mm256_set1_epi8(4));
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')));
+    return _mm256_or_si256(m, _mm256_cmpeq_epi8(x, _mm256_setzero_si256()));
+}
+
+PDF_TARGET_AVX2 static __m256i _regular_mask32(__m256i x) {
+    __m256i r = _mm256_sub_epi8(x, _mm256_set1_epi8('!'));
+    __m256i m = _mm256_cmpeq_epi8(_mm256_max_epu8(r, _mm256_set1_epi8('~' - '!')), _mm256_set1_epi8('~' - '!'));
+    __m256i d = _mm256_cmpeq_epi8(_mm256_or_si256(x, _mm256_set1_epi8(0x01)), _mm256_set1_epi8(')'));
+    d = _mm256_or_si256(d, _mm256_cmpeq_epi8(_mm256_or_si256(x, _mm256_set1_epi8(0x02)), _mm256_set1_epi8('>')));
+    d = _mm256_or_si256(d, _mm256_cmpeq_epi8(_mm256_or_si256(x, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('{')));
+    d = _mm256_or_si256(d, _mm256_cmpeq_epi8(_mm256_or_si256(x, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('}')));
+    d = _mm256_or_si256(d, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('/')));
+    d = _mm256_or_si256(d, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('%')));
+    return _mm256_andnot_si256(d, m);
+}
+
+PDF_TARGET_AVX2 static __m256i _eol_mask32(__m256i x) {
+    return _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\n')),
+                           _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\r')));
+}
+
+#define SCAN_SPAN32(name, mask_fn, tail_fn)                             \
+    PDF_TARGET_AVX2 static size_t name(const char* p, size_t n, size_t i) { \
+        for (; i + 32 <= n; i += 32) {                                  \
+            uint32_t m = _mm256_movemask_epi8(mask_fn(_mm256_loadu_si256((const __m256i*)(p + i)))); \
+            if (m != 0xFFFFFFFF) return i + _ctz(~m);                   \
+        }                                                               \
+        return tail_fn(p, n, i);                                        \
+    }
+
+SCAN_SPAN32(_scan_space_avx2, _space_mask32, _scan_space_sse2)
+SCAN_SPAN32(_scan_regular_avx2, _regular_mask32, _scan_regular_sse2)
+
+PDF_TARGET_AVX2 static size_t _scan_eol_avx2(const char* p, size_t n, size_t i) {
+    for (; i + 32 <= n; i += 32) {
+        uint32_t m = _mm256_movemask_epi8(_eol_mask32(_mm256_loadu_si256((const __m256i*)(p + i))));
+        if (m) return i + _ctz(m);
+    }
+    return _scan_eol_sse2(p, n, i);
+}
+
+#endif
+
+/* Runs are often short. Check a few characters before going wide. */
+#if defined(PDF_AVX2)
+#define SCAN_WIDE(kind, p, n, i) (n - i >= 32 && _have_avx2() \
+                                  ? _scan_##kind##_avx2(p, n, i)  \
+                                  : _scan_##kind##_sse2(p, n, i))
+#elif defined(PDF_SSE2)
+#define SCAN_WIDE(kind, p, n, i) _scan_##kind##_sse2(p, n, i)
+#else
+#define SCAN_WIDE(kind, p, n, i) _scan_##kind##_scalar(p, n, i)
+#endif
+
+DLLEXPORT size_t pdf_scan_space(const char* p, size_t n) {
+    size_t i = _scan_space_scalar(p, n < SCAN_PREFIX ? n : SCAN_PREFIX, 0);
+    return i < SCAN_PREFIX ? i : SCAN_WIDE(space, p, n, i);
+}
+
+DLLEXPORT size_t pdf_scan_regular(const char* p, size_t n) {
+    size_t i = _scan_regular_scalar(p, n < SCAN_PREFIX ? n : SCAN_PREFIX, 0);
+    return i < SCAN_PREFIX ? i : SCAN_WIDE(regular, p, n, i);
+}
+
+DLLEXPORT size_t pdf_scan_eol(const char* p, size_t n) {
+    size_t i = _scan_eol_scalar(p, n < SCAN_PREFIX ? n : SCAN_PREFIX, 0);
+    return i < SCAN_PREFIX ? i : SCAN_WIDE(eol, p, n, i);
+}
+
+DLLEXPORT size_t pdf_scan_find(const char* p, size_t n, const char* s, size_t m) {
+    size_t i = 0, end;
+    if (m == 0 || m > n) return n;
+    end = n - m + 1; /* candidate positions are 0 .. end-1 */
+
+#ifdef PDF_SSE2
+    {
+        /* match the first and last characters of the string, 16 positions
+           at a time, then confirm candidates */
+        __m128i first = _mm_set1_epi8(s[0]);
+        __m128i last  = _mm_set1_epi8(s[m - 1]);
+
+        for (; i + 16 <= end; i += 16) {
+            __m128i f = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + i)), first);
+            __m128i l = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + i + m - 1)), last);
+            uint32_t mask = _mm_movemask_epi8(_mm_and_si128(f, l));
+
+            while (mask) {
+                unsigned bit = _ctz(mask);
+                if (memcmp(p + i + bit, s, m) == 0) return i + bit;
+                mask &= mask - 1;
+            }
+        }
+    }
+#endif
+
+    for (; i < end; i++) {
+        if (p[i] == s[0] && memcmp(p + i, s, m) == 0) return i;
+    }
+    return n;
+}
+
+DLLEXPORT size_t pdf_scan_rfind(const char* p, size_t n, const char* s, size_t m) {
+    size_t i;
+    if (m == 0 || m > n) return n;
+    i = n - m + 1; /* candidate positions are 0 .. i-1 */
+
+#ifdef PDF_SSE2
+    {
+        /* match the first and last characters of the string, 16 positions
+           at a time, then confirm candidates, working backwards */
+        __m128i first = _mm_set1_epi8(s[0]);
+        __m128i last  = _mm_set1_epi8(s[m - 1]);
+
+        while (i >= 16) {
+            size_t base = i - 16;
+            __m128i f = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + base)), first);
+            __m128i l = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + base + m - 1)), last);
+            uint32_t mask = _mm_movemask_epi8(_mm_and_si128(f, l));
+
+            while (mask) {
+                unsigned bit = _msb(mask);
+                if (memcmp(p + base + bit, s, m) == 0) return base + bit;
+                mask &= ~(1u << bit);
+            }
+            i = base;
+        }
+    }
+#endif
+
+    while (i-- > 0) {
+        if (p[i] == s[0] && memcmp(p + i, s, m) == 0) return i;
+    }
+    return n;
+}
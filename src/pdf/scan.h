@@ -0,0 +1,33 @@
+#ifndef PDF_SCAN_H_
+#define PDF_SCAN_H_
+
+#include "pdf.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/* PDF character classes, as used by the tokenizer. These replace the
+ * locale-dependent <ctype.h> functions. */
+#define PDF_CC_SPACE   0x01 /* HT, LF, VT, FF, CR, SP */
+#define PDF_CC_NUL     0x02 /* also skipped as whitespace */
+#define PDF_CC_DELIM   0x04 /* ( ) < > [ ] { } / % */
+#define PDF_CC_DIGIT   0x08 /* 0-9 */
+#define PDF_CC_GRAPH   0x10 /* printable ASCII, '!' .. '~' */
+#define PDF_CC_REGULAR 0x20 /* printable, but not a delimiter */
+#define PDF_CC_EOL     0x40 /* CR, LF */
+
+extern const uint8_t pdf_char_class[256];
+
+#define PDF_CC(ch, cc) (pdf_char_class[(uint8_t)(ch)] & (cc))
+
+/* length of the leading run of whitespace, including NULs */
+DLLEXPORT size_t pdf_scan_space(const char*, size_t);
+/* length of the leading run of regular printable characters */
+DLLEXPORT size_t pdf_scan_regular(const char*, size_t);
+/* offset of the first CR or LF, or the length, if there is none */
+DLLEXPORT size_t pdf_scan_eol(const char*, size_t);
+/* offset of the first occurrence of a string, or the length, if there is none */
+DLLEXPORT size_t pdf_scan_find(const char*, size_t, const char*, size_t);
+/* offset of the last occurrence of a string, or the length, if there is none */
+DLLEXPORT size_t pdf_scan_rfind(const char*, size_t, const char*, size_t);
+
+#endif
@@ -21,7 +21,7 @@ static utf_t * utf[] = {
 	[2] = &(utf_t){0b00011111, 0b11000000, 0200,    03777,    5    },
 	[3] = &(utf_t){0b00001111, 0b11100000, 04000,   0177777,  4    },
 	[4] = &(utf_t){0b00000111, 0b11110000, 0200000, 04177777, 3    },
-	      &(utf_t){0},
+	      NULL,
 };
 
 int utf8_code_len(const uint32_t cp)
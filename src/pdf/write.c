@@ -5,6 +5,7 @@
 #include <string.h>
 #include <inttypes.h>
 #include <assert.h>
+#include <math.h>
 #include "pdf.h"
 #include "pdf/types.h"
 #include "pdf/write.h"
@@ -17,20 +18,93 @@ DLLEXPORT size_t pdf_write_bool(PDF_TYPE_BOOL val, char *out, size_t out_len) {
     return strnlen(out, out_len);
 }
 
+static const char _digit_pairs[] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+static size_t _digits(uint64_t val) {
+  size_t n = 1;
+  for (;;) {
+    if (val < 10) return n;
+    if (val < 100) return n + 1;
+    if (val < 1000) return n + 2;
+    if (val < 10000) return n + 3;
+    val /= 10000;
+    n += 4;
+  }
+}
+
+/* write exactly n digits, backwards from out + n */
+static void _write_digits(uint64_t val, char* out, size_t n) {
+  char* p = out + n;
+  while (val >= 100) {
+    const char* d = _digit_pairs + 2 * (val % 100);
+    val /= 100;
+    *--p = d[1];
+    *--p = d[0];
+  }
+  if (val >= 10) {
+    const char* d = _digit_pairs + 2 * val;
+    *--p = d[1];
+    *--p = d[0];
+  }
+  else {
+    *--p = '0' + (char) val;
+  }
+  /* leading zeros */
+  while (p > out) *--p = '0';
+}
+
+static size_t _write_uint64(int neg, uint64_t val, char *out, size_t out_len) {
+  size_t n = _digits(val);
+  if (n + neg > out_len) return 0;
+  if (neg) *out++ = '-';
+  _write_digits(val, out, n);
+  return n + neg;
+}
+
 DLLEXPORT size_t pdf_write_int(PDF_TYPE_INT64 val, char *out, size_t out_len) {
-  char buf[32];
-  snprintf(buf, sizeof(buf), "%" PRId64, val);
-  strncpy(out, buf, out_len);
-  return strnlen(out, out_len);
+  return val < 0
+    ? _write_uint64(1, 0 - (uint64_t) val, out, out_len)
+    : _write_uint64(0, val, out, out_len);
 }
 
-DLLEXPORT size_t pdf_write_real(PDF_TYPE_REAL val, char *out, size_t out_len) {
+/* Round |val| * scale to an integer, exactly as printf would round |val| to
+ * that many decimal places: the rounded product is corrected by its rounding
+ * error (Dekker's two-product; scale is small enough not to need splitting)
+ * and exact halves go to even. */
+static uint64_t _round_scaled(double val, double scale) {
+  const double split = 134217729.0; /* 2^27 + 1 */
+  double c = split * val;
+  double hi = c - (c - val);
+  double lo = val - hi;
+  double p = val * scale;
+  double err = (hi * scale - p) + lo * scale;
+  uint64_t q = (uint64_t) p;
+  double frac = p - (double) q;
+
+  if (frac > 0.5 || (frac == 0.5 && (err > 0 || (err == 0 && (q & 1))))) {
+    q++;
+  }
+  return q;
+}
+
+#define PDF_WRITE_REAL_MAX_FAST 1e14
+
+static size_t _write_real_fmt(PDF_TYPE_REAL val, const char* fmt, char *out, size_t out_len) {
   char   buf[32];
   char   *t;
   char   *dp;
   size_t n;
 
-  const char* fmt = (val > 9999999 || -val > 9999999) ? "%.1f" : "%.5f";
   snprintf(buf, sizeof(buf), fmt, val);
 
   dp = strchr(buf, '.');
@@ -50,6 +124,42 @@ DLLEXPORT size_t pdf_write_real(PDF_TYPE_REAL val, char *out, size_t out_len) {
   return n;
 }
 
+/* Same output as "%.5f" (or "%.1f" for magnitudes over 9999999), with trailing
+ * zeros and any trailing '.' trimmed, but formatted directly and independently
+ * of the locale. Huge values, NaN and Inf are still handed to snprintf(). */
+DLLEXPORT size_t pdf_write_real(PDF_TYPE_REAL val, char *out, size_t out_len) {
+  int neg = signbit(val) ? 1 : 0;
+  double mag = neg ? -val : val;
+  int places = mag > 9999999 ? 1 : 5;
+  uint64_t scale = places == 1 ? 10 : 100000;
+  uint64_t q, int_part, frac;
+  size_t n;
+
+  if (!(mag < PDF_WRITE_REAL_MAX_FAST)) {
+    return _write_real_fmt(val, places == 1 ? "%.1f" : "%.5f", out, out_len);
+  }
+
+  q = _round_scaled(mag, (double) scale);
+  int_part = q / scale;
+  frac = q % scale;
+
+  n = _write_uint64(neg, int_part, out, out_len);
+  if (n == 0) return 0;
+
+  if (frac) {
+    while (frac % 10 == 0) {
+      frac /= 10;
+      places--;
+    }
+    if (n + 1 + places > out_len) return 0;
+    out[n++] = '.';
+    _write_digits(frac, out + n, places);
+    n += places;
+  }
+
+  return n;
+}
+
 DLLEXPORT size_t pdf_write_literal(PDF_TYPE_STRING val, size_t in_len, char* out, size_t out_len) {
 
   PDF_TYPE_STRING in_p = val;
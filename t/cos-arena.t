@@ -0,0 +1,51 @@
+use PDF::Native::COS;
+use PDF::Native::Defs :libpdf;
+use NativeCall;
+use Test;
+
+plan 7;
+
+sub cos_arena_new(size_t --> Pointer) is native(libpdf) {*}
+sub cos_arena_done(Pointer) is native(libpdf) {*}
+sub cos_array_new_in(Pointer, CArray[COSNode], size_t --> Pointer) is native(libpdf) {*}
+sub cos_ind_obj_new_in(Pointer, uint64, uint32, COSNode --> Pointer) is native(libpdf) {*}
+sub cos_parse_ind_obj_in(Pointer, Blob, size_t, int32 --> Pointer) is native(libpdf) {*}
+sub cos_parse_content_in(Pointer, Blob, size_t --> Pointer) is native(libpdf) {*}
+sub cos_ind_obj_write(Pointer, Blob, size_t --> size_t) is native(libpdf) {*}
+sub cos_node_cmp(Pointer, COSNode --> int32) is native(libpdf) {*}
+
+# a heap node, as a member of arena containers
+my COSInt $int .= new: :value(42);
+is $int.ref-count, 1, 'heap node';
+
+my Pointer $arena = cos_arena_new(4096);
+cos_array_new_in($arena, CArray[COSNode].new($int), 1);
+cos_ind_obj_new_in($arena, 1, 0, $int);
+is $int.ref-count, 1, 'arena containers hold no references';
+
+cos_arena_done($arena);
+is $int.ref-count, 1, 'nothing held after cos_arena_done()';
+
+# parse whole object graphs into an arena. Arena nodes are only accessed
+# natively; they can't outlive the arena
+my $obj = "12 0 obj\n<< /Type /XObject /Kids [ 1 0 R (lit) <6869> 4.5 true null ] /Length 5 >> stream\nhello\nendstream\nendobj\n";
+my blob8 $obj-buf = $obj.encode: 'latin-1';
+my $content = 'BT /F1 24 Tf (Hello) Tj [ (a) 10 <62> ] TJ ET';
+my blob8 $content-buf = $content.encode: 'latin-1';
+
+$arena = cos_arena_new(4096);
+my Pointer $ind-obj = cos_parse_ind_obj_in($arena, $obj-buf, $obj-buf.bytes, 1);
+ok $ind-obj.defined, 'parse indirect object into an arena';
+is cos_node_cmp($ind-obj, COSIndObj.parse($obj-buf, :scan)), +COS_CMP_EQUAL, 'indirect object matches a heap parse';
+
+my buf8 $buf .= allocate(512);
+my $n = cos_ind_obj_write($ind-obj, $buf, $buf.bytes);
+is-deeply $buf.subbuf(0, $n).decode('latin-1').lines, (
+    '12 0 obj', '<<', '  /Type /XObject', '  /Kids [ 1 0 R (lit) <6869> 4.5 true null ]', '  /Length 5',
+    '>> stream', 'hello', 'endstream', 'endobj'), 'arena object write';
+
+my Pointer $parsed-content = cos_parse_content_in($arena, $content-buf, $content-buf.bytes);
+is cos_node_cmp($parsed-content, COSContent.parse($content)), +COS_CMP_EQUAL, 'content matches a heap parse';
+
+# releases both graphs
+cos_arena_done($arena);
@@ -0,0 +1,85 @@
+use PDF::Native::COS :DEFAULT, :CLIB;
+use PDF::Native::Defs :libpdf;
+use NativeCall;
+use Test;
+
+plan 10;
+
+constant BORROW = 0x10;
+
+sub malloc(size_t --> Pointer) is native($CLIB) {*}
+sub free(Pointer) is native($CLIB) {*}
+sub memcpy(Pointer, Blob, size_t) is native($CLIB) {*}
+
+sub cos_literal_borrow(Pointer, size_t --> Pointer) is native(libpdf) {*}
+sub cos_hex_string_borrow(Pointer, size_t --> Pointer) is native(libpdf) {*}
+sub cos_stream_borrow(COSDict, Pointer, size_t --> Pointer) is native(libpdf) {*}
+sub cos_parse_ind_obj(Pointer, size_t, int32 --> Pointer) is native(libpdf) {*}
+sub cos_node_done(Pointer) is native(libpdf) {*}
+
+# borrowed nodes reference a native buffer, which we allocate and free ourselves
+sub native-buf(Str $s --> Pointer) {
+    my blob8 $bytes = $s.encode: 'latin-1';
+    my Pointer $p = malloc($bytes.bytes);
+    memcpy($p, $bytes, $bytes.bytes);
+    $p;
+}
+sub native-str(Pointer $p, UInt $n --> Str) {
+    blob8.new(nativecast(CArray[uint8], $p)[^$n]).decode: 'latin-1';
+}
+sub scribble(Pointer $p, UInt $n) {
+    my $bytes := nativecast(CArray[uint8], $p);
+    $bytes[$_] = 'X'.ord for ^$n;
+}
+
+my $obj = "12 0 obj\n<< /Type /XObject /Name /Im1 /Title (lit) /ID <6869> /Length 5 >> stream\nhello\nendstream\nendobj\n";
+my COSDict $dict = COSNode.parse: '<< /Length 5 >>';
+
+# cos_node_done() leaves the caller's buffer alone; a free() of it in the
+# library would show up as a double free below
+for (
+    'literal string' => { cos_literal_borrow($^p, 5) },
+    'hex string'     => { cos_hex_string_borrow($^p, 5) },
+    'stream'         => { cos_stream_borrow($dict, $^p, 5) },
+) {
+    my Pointer $p = native-buf('hello');
+    cos_node_done(.value.($p));
+    is native-str($p, 5), 'hello', "{.key} done; buffer intact";
+    free($p);
+}
+
+given native-buf($obj) -> $p {
+    cos_node_done(cos_parse_ind_obj($p, $obj.chars, 1 +| BORROW));
+    is native-str($p, $obj.chars), $obj, 'borrowed parse done; buffer intact';
+    free($p);
+}
+
+# materialized nodes own their payloads
+given native-buf('hello') -> $p {
+    my COSLiteralString $lit = nativecast(COSLiteralString, cos_literal_borrow($p, 5));
+    my COSStream $stream = nativecast(COSStream, cos_stream_borrow($dict, $p, 5));
+    $lit.materialize;
+    $stream.materialize;
+    scribble($p, 5);
+    free($p);
+    is $lit.Str, 'hello', 'materialized literal string';
+    is $stream.ast.value<encoded>, 'hello', 'materialized stream';
+}
+
+given native-buf($obj) -> $p {
+    my COSIndObj $ind-obj = nativecast(COSIndObj, cos_parse_ind_obj($p, $obj.chars, 1 +| BORROW));
+    $ind-obj.materialize;
+    scribble($p, $obj.chars);
+    free($p);
+    is $ind-obj.Str, COSIndObj.parse($obj, :scan).Str, 'materialized indirect object';
+}
+
+# borrowing is invisible in the parsed AST
+given native-buf($obj) -> $p {
+    my COSIndObj $borrowed = nativecast(COSIndObj, cos_parse_ind_obj($p, $obj.chars, 1 +| BORROW));
+    my COSIndObj $copied = COSIndObj.parse($obj, :scan);
+    is-deeply $borrowed.ast, $copied.ast, 'borrowed parse AST';
+    is $borrowed.Str, $copied.Str, 'borrowed parse serialization';
+    $borrowed.materialize;
+    free($p);
+}
@@ -31,6 +31,8 @@ subtest 'numeric', {
     is $two.cmp(parse("2.1")), +COS_CMP_DIFFERENT;
     is $two.cmp($one), +COS_CMP_DIFFERENT;
     is $one.cmp($two), +COS_CMP_DIFFERENT;
+    is parse("2.5").cmp(parse("2.50")), +COS_CMP_EQUAL;
+    is parse("2.5").cmp(parse("2.25")), +COS_CMP_DIFFERENT;
 }
 
 subtest 'string', {
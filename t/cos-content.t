@@ -2,7 +2,7 @@ use PDF::Native::COS;
 use NativeCall;
 use Test;
 
-plan 16;
+plan 20;
 
 my COSContent $content .= parse: "BT /F1 24 Tf  100 250 Td (Hello, world!) Tj ET";
 ok $content.defined, "content parse";
@@ -28,11 +28,16 @@ is-deeply $content.write.lines, ('BI', '/Foo (bar) ID', ' abc', 'EI');
 $content .= parse: "BI ID ab EIcEI EI";
 is-deeply $content.ast, 'content' => [:BI[], :ID[:dict{},  :encoded("ab EIcEI")], :EI[]];
 
+$content .= parse: "BI ID " ~ "xEIy EIz\n" x 20 ~ " EI";
+is-deeply $content.ast, 'content' => [:BI[], :ID[:dict{},  :encoded("xEIy EIz\n" x 20)], :EI[]], 'inline image false EI hits';
+
 $content .= parse: "BI /L 7 ID  abc EI EI";
 is-deeply $content.ast, 'content' => [:BI[], :ID[:dict{:L(7)}, :encoded(" abc EI")], :EI[]];
 
 is-deeply $content.write.lines, ('BI', '/L 7 ID', ' abc EI', 'EI');
 
+nok COSContent.parse("BI /W 1 ID").defined, "inline image 'ID' at end of input";
+
 $content .= parse: "XX /Y 6 ZZ 42 Td";
 is-deeply $content.ast, 'content' => ['??' => :XX[], '??' => :ZZ[:name<Y>, 6], '??' => :Td[42]];
 
@@ -43,4 +48,8 @@ $content .= COERCE: [ :BT[], :comment["test comment"], :ET[] ];
 is-deeply $content.ast, 'content' => [ :BT[], :comment["test comment"], :ET[] ];
 is-deeply $content.write.lines, ('BT', '  % test comment', 'ET');
 
+$content .= parse: (^10_000).map({"$_ 0 m"}).join("\n");
+is $content.elems, 10_000, 'parse long content';
+is-deeply $content[9_999].ast, :m[9_999, 0], 'parse long content';
+
 done-testing;
@@ -1,7 +1,7 @@
 use PDF::Native::COS;
 use Test;
 
-plan 16;
+plan 21;
 
 sub parse(Str:D $str) {
     COSNode.parse: $str;
@@ -45,4 +45,12 @@ is-deeply $dict.Str(:$buf).lines, $str.lines;
 
 is-deeply COSNode.COERCE($dict.ast).Str.lines, $str.lines;
 
+# large enough to be hashed
+$dict = parse('<<' ~ (^1000).map({ "/W$_ $_" }).join(' ') ~ ' /W5 null /W7 77 >>');
+is $dict<W0>.value, 0;
+is $dict<W999>.value, 999;
+is $dict<W5>.value, 5, 'null duplicate ignored';
+is $dict<W7>.value, 77, 'last duplicate wins';
+is-deeply $dict<W1000>, COSNode;
+
 done-testing;
\ No newline at end of file
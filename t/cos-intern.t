@@ -0,0 +1,37 @@
+use PDF::Native::COS;
+use PDF::Native::Defs :libpdf;
+use NativeCall;
+use Test;
+
+plan 14;
+
+constant COS_NODE_FLAG_INTERNED = 4;
+
+sub cos_node_done(COSNode) is native(libpdf) {*}
+sub addr(COSNode:D $node) { +nativecast(Pointer, $node) }
+
+# common names are shared from the static table
+for <Type Length Filter> -> $str {
+    my COSName() $a = $str;
+    my COSName() $b = $str;
+    is addr($a), addr($b), "/$str is shared";
+    ok $a.flags +& COS_NODE_FLAG_INTERNED, "/$str is interned";
+}
+
+my COSName() $type = 'Type';
+is addr(COSNode.parse('/Type')), addr($type), 'parsed /Type is shared';
+
+# interned names aren't ref-counted, or released
+$type.reference for ^3;
+is $type.ref-count, 1, 'reference() on an interned name';
+cos_node_done($type) for ^5;
+is $type.ref-count, 1, 'cos_node_done() on an interned name';
+is $type.Str, 'Type', 'interned name intact';
+
+# names outside of the table, or over COS_NAME_INTERN_MAX_LEN, are fresh nodes
+for ('/Hello!' => 'Hello!', 'long name' => 'Type' x 9) {
+    my COSName() $a = .value;
+    my COSName() $b = .value;
+    isnt addr($a), addr($b), "{.key} is fresh";
+    nok $a.flags +& COS_NODE_FLAG_INTERNED, "{.key} isn't interned";
+}
@@ -1,7 +1,7 @@
 use PDF::Native::COS;
 use Test;
 
-plan 8;
+plan 9;
 
 my COSIndObj $ind-obj .= parse: "10 0 obj 42 endobj";
 ok $ind-obj.defined;
@@ -39,6 +39,15 @@ subtest 'scan', {
     is-deeply $ind-obj.parse($stream-obj, :scan).Str.lines, $stream-obj.lines;
 }
 
+subtest 'scan /Length', {
+    my $objs = "1 0 obj << /Length 14 >> stream\nendstream oops\nendstream endobj\n"
+             ~ "2 0 obj << /Length 3 >> stream\nabc\nendstream endobj\n";
+    my COSStream:D $stream = $ind-obj.parse($objs, :scan).value;
+    is $stream.value-len, 14, 'stream extent from /Length';
+    $stream = $ind-obj.parse("1 0 obj << /Length 99 >> stream\nabc\nendstream endobj\n", :scan).value;
+    is $stream.value-len, 3, 'bad /Length; scanned for endstream';
+}
+
 subtest 'attach', {
     my Blob $in-buf = $stream-obj.encode: "latin-1";
     $ind-obj .= parse: $in-buf;
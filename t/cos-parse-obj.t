@@ -1,7 +1,7 @@
 use PDF::Native::COS;
 use Test;
 
-plan 75;
+plan 91;
 
 given COSNode.parse('123') {
     .&isa-ok: COSInt;
@@ -18,6 +18,10 @@ given COSNode.parse('.45') {
     is .Str, '0.45', 'parse real fraction';
 }
 
+for '-.002' => -.002e0, '4.' => 4e0, '0.30000000000000004' => 0.30000000000000004e0, '1.000000000000000000000001' => 1e0 {
+    is COSNode.parse(.key).value, .value, 'parse real ' ~ .key;
+}
+
 given COSNode.parse('[]') {
     .&isa-ok: COSArray;
     is .Str, '[ ]', 'parse array';
@@ -28,6 +32,11 @@ given COSNode.parse("\n \%xxx\n[\%yyy\n]\%zzz\n ") {
     is .Str, '[ ]', 'parse array + ws/comments';
 }
 
+given COSNode.parse("[" ~ ' ' x 40 ~ '/' ~ 'x' x 70 ~ '%' ~ 'c' x 50 ~ "\r/" ~ 'y' x 33 ~ "/z\0\t]") {
+    .&isa-ok: COSArray;
+    is .write, '[ /' ~ 'x' x 70 ~ ' /' ~ 'y' x 33 ~ ' /z ]', 'parse long token and whitespace runs';
+}
+
 given COSNode.parse('(Hello,\40World\n)') {
     .&isa-ok: COSLiteralString;
     is .Str.chomp, 'Hello, World', 'parse literal';
@@ -77,6 +86,14 @@ given COSNode.parse('/Hello,#20World#21') {
     is .write, '/Hello,#20World!', 'parse name';
 }
 
+given COSNode.parse('/Heyd#C9#99r#20#C6#8Fliyev') {
+    .&isa-ok: COSName;
+    is .Str, 'Heydər Əliyev', 'parse utf-8 name';
+    is .value-len, 13, 'utf-8 name length';
+}
+
+ok !COSNode.parse('/Bad#2'), 'truncated name escape';
+
 for '', 'PTEX.Fullbanner' -> $s {
     given COSNode.parse('/'~$s) {
         .&isa-ok: COSName;
@@ -139,3 +156,15 @@ given COSNode.parse('<</a 42/BB(Hi)>>') {
     is .Str, '<< /a 42 /BB (Hi) >>', 'parse dict';
 }
 
+given COSNode.parse('[' ~ (1..10_000).join(' ') ~ ']') {
+    .&isa-ok: COSArray;
+    is .elems, 10_000, 'parse long array';
+    is .[9_999].Int, 10_000, 'parse long array';
+}
+
+given COSNode.parse(('[' x 1000) ~ (']' x 1000)) {
+    .&isa-ok: COSArray;
+    is .write.chars, 3 + 999 * 4, 'parse deeply nested array';
+}
+
+is-deeply COSNode.parse(('[' x 1000) ~ (']' x 999)), COSNode, 'unterminated nested array';
@@ -1,7 +1,7 @@
 use PDF::Native::COS;
 use Test;
 
-plan 5;
+plan 6;
 
 my COSRef $ref .= new: :obj-num(42);
 
@@ -11,4 +11,7 @@ is $ref.obj-num, 42;
 is $ref.gen-num, 0;
 is $ref.Str, '42 0 R';
 
+$ref.reference for ^70_000;
+is $ref.ref-count, 70_001, 'ref-count beyond 16 bits';
+
 done-testing;
\ No newline at end of file
@@ -0,0 +1,50 @@
+use v6;
+use Test;
+plan 10;
+
+use PDF::Native::COS;
+use PDF::Native::Filter::ASCIIHex;
+use PDF::Native::Filter::Flate;
+use PDF::Native::Filter::LZW;
+
+sub dict(Str:D $str --> COSDict:D) { COSNode.parse: $str }
+
+my $data = blob8.new: (^12000).map: { ($_ * 7 + $_ div 30) % 256 };
+
+my COSStream $stream .= new: :dict(dict '<< /Filter /AHx >>'), :value('48656c6c6f>'.encode);
+is-deeply $stream.decoded, blob8.new('Hello'.encode), 'abbreviated name';
+
+$stream .= new: :dict(dict '<< >>'), :value($data);
+is-deeply $stream.decoded, $data, 'no filters';
+
+my $lzw = PDF::Native::Filter::LZW.encode($data, :Predictor(12), :Columns(30));
+$stream .= new: :dict(dict '<< /Filter [/ASCIIHexDecode /LZWDecode] /DecodeParms [null << /Predictor 12 /Columns 30 >>] >>'),
+                :value(PDF::Native::Filter::ASCIIHex.encode($lzw));
+is-deeply $stream.decoded, $data, 'chain, with predictors';
+
+$stream = COSStream.encode($data, :dict(dict '<< /Filter [/ASCII85Decode /RunLengthDecode /LZWDecode] >>'));
+is-deeply $stream.decoded, $data, 'encode, decode round-trip';
+
+$stream .= new: :dict(dict '<< /Filter /DCTDecode >>'), :value($data);
+nok $stream.decoded.defined, 'unsupported filter';
+
+$stream .= new: :dict(dict '<< /Filter /AHx >>'), :value('6x>'.encode);
+dies-ok { $stream.decoded }, 'decode error';
+
+$stream .= new: :dict(dict '<< /Filter [/AHx /RL] /DecodeParms [null] >>'), :value($data);
+dies-ok { $stream.decoded }, '/DecodeParms mismatch';
+
+$stream .= new: :dict(dict '<< /Filter /LZW /DecodeParms << /Predictor 2 /BitsPerComponent 12 /Columns 4 >> >>'), :value($lzw);
+dies-ok { $stream.decoded }, 'unsupported /BitsPerComponent';
+
+if PDF::Native::Filter::Flate.available {
+    my $flate = PDF::Native::Filter::Flate.encode($data, :Predictor(2), :Colors(3), :Columns(10));
+    $stream .= new: :dict(dict '<< /Filter /FlateDecode /DecodeParms << /Predictor 2 /Colors 3 /Columns 10 >> >>'), :value($flate);
+    is-deeply $stream.decoded, $data, 'flate, with predictors';
+
+    $stream = COSStream.encode($data, :dict(dict '<< /Filter [/A85 /Fl] /DecodeParms [null << /Predictor 15 /Columns 40 >>] >>'));
+    is-deeply $stream.decoded, $data, 'flate round-trip';
+}
+else {
+    skip "libpdf was built without zlib", 2;
+}
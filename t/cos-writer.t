@@ -0,0 +1,88 @@
+use PDF::Native::COS;
+use NativeCall;
+use PDF::Native::Reader;
+use PDF::Native::Filter::Flate;
+use Test;
+
+plan 20;
+
+my buf8 $out .= new;
+
+sub write-func(COSWriter $, CArray[uint8] $buf, size_t $len --> size_t) {
+    $out.append: $buf[^$len];
+    $len;
+}
+
+my COSWriter:D $writer .= new: :&write-func, :buf-size(64);
+
+my COSIndObj $ind-obj .= parse: q:to<END>, :scan;
+5 0 obj
+<< /Type /Page /Contents 6 0 R /MediaBox [ 0 0 420 595 ] /Parent 4 0 R /Resources << /Font << /F1 7 0 R >> /Procset [ /PDF /Text ] >> >>
+endobj
+END
+
+ok $writer.write($ind-obj), 'write ind-obj';
+ok $writer.flush, 'flush';
+is $out.decode("latin-1"), $ind-obj.write, 'streamed output';
+is $writer.pos, $out.bytes, 'pos';
+
+my COSContent $content .= parse: "BT /F1 24 Tf  100 250 Td (Hello, world!) Tj ET % done";
+$out .= new;
+$writer.write($content);
+$writer.put("\n".encode);
+$writer.flush;
+is $out.decode("latin-1"), $content.write ~ "\n", 'streamed content';
+
+my COSDict $dict .= parse: '<< /A (' ~ ('x' x 1000) ~ ') /B 2 >>';
+$out .= new;
+$writer.write($dict, :compact);
+$writer.flush;
+is $out.decode("latin-1"), $dict.write(:compact), 'streamed long string';
+is $writer.error, 0, 'no errors';
+
+my COSIndObj @objects = (3, 1, 2).map: -> $n { COSIndObj.parse: "$n 0 obj << /N $n >> endobj" };
+my COSDict $trailer .= parse: '<< /Root 1 0 R /Size 42 >>';
+
+$out .= new;
+$writer .= new: :&write-func;
+ok $writer.write-pdf(@objects, $trailer), 'write-pdf';
+$writer.flush;
+my Str $pdf = $out.decode("latin-1");
+ok $pdf.starts-with("%PDF-1.4\n"), 'pdf header';
+ok $pdf.contains("trailer\n<< /Size 4 /Root 1 0 R >>\nstartxref\n"), 'pdf trailer';
+$pdf ~~ /'startxref' \n (\d+)/;
+my array $xref = PDF::Native::Reader.new.read-xref($out.subbuf(+$0));
+is-deeply $xref.rotor(4).grep(*[1]).map({ $pdf.substr(.[2], 7) }).list, ('1 0 obj', '2 0 obj', '3 0 obj'), 'xref offsets';
+
+$out .= new;
+$writer .= new: :&write-func;
+ok $writer.write-pdf(@objects, $trailer, :version<1.5>, :xref-stream), 'write-pdf :xref-stream';
+$writer.flush;
+$pdf = $out.decode("latin-1");
+$pdf ~~ /'startxref' \n (\d+)/;
+my COSIndObj $xref-stream .= parse: $out.subbuf(+$0);
+is $xref-stream.obj-num, 4, 'xref stream object number';
+is $xref-stream.value.dict<Size>.Int, 5, 'xref stream /Size';
+if PDF::Native::Filter::Flate.available {
+    $xref-stream .= parse: $out.subbuf(+$0), :scan;
+    is $xref-stream.value.dict<Filter>.Str, 'FlateDecode', 'xref stream is compressed';
+    my $W = $xref-stream.value.dict<W>;
+    is $xref-stream.value.decoded.bytes, 5 * (^3).map({ $W[$_].Int }).sum, 'xref stream decodes';
+}
+else {
+    skip "libpdf was built without zlib", 2;
+}
+
+@objects = (1..100).map: -> $n { COSIndObj.parse: "$n 0 obj << /N $n >> endobj" };
+my COSWriteBatch $batch .= new: :@objects, :threads(4), :pos(10);
+is $batch.elems, 100, 'batch elems';
+is $batch.Str, @objects>>.Str.join, 'batch output';
+my @lens = @objects>>.Str>>.chars;
+is-deeply $batch.offsets, ([\+] 10, |@lens[^99]).list, 'batch offsets';
+$out .= new;
+$writer .= new: :&write-func;
+$writer.put($batch);
+$writer.flush;
+is $out.decode("latin-1"), $batch.Str, 'put batch';
+
+done-testing;
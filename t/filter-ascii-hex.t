@@ -0,0 +1,22 @@
+use v6;
+use Test;
+plan 7;
+
+use lib 't/lib';
+use FilterTest;
+use PDF::Native::Filter::ASCIIHex;
+use PDF::Native::Filter::ASCIIHex::Stream;
+
+is-deeply PDF::Native::Filter::ASCIIHex.encode('snoopy'.encode), blob8.new('736e6f6f7079>'.encode), 'encode';
+is-deeply PDF::Native::Filter::ASCIIHex.decode("73 6E\n6f6F 7079>".encode), blob8.new('snoopy'.encode), 'decode, with whitespace';
+is-deeply PDF::Native::Filter::ASCIIHex.decode('7>'.encode), blob8.new(0x70), 'odd number of digits';
+
+my $data = test-data(1000);
+my $encoded = PDF::Native::Filter::ASCIIHex.encode($data);
+is $encoded.decode.lines.map(*.chars).max, 64, 'line length';
+is-deeply PDF::Native::Filter::ASCIIHex.decode($encoded), $data, 'round-trip';
+
+my PDF::Native::Filter::ASCIIHex::Stream $decoder .= new;
+is-deeply streamed($decoder, $encoded, 7), buf8.new($data), 'streamed decoding';
+
+dies-ok { PDF::Native::Filter::ASCIIHex.decode('6x>'.encode) }, 'illegal character';
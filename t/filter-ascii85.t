@@ -0,0 +1,24 @@
+use v6;
+use Test;
+plan 8;
+
+use lib 't/lib';
+use FilterTest;
+use PDF::Native::Filter::ASCII85;
+use PDF::Native::Filter::ASCII85::Stream;
+
+my $text = 'Man is distinguished'.encode;
+is-deeply PDF::Native::Filter::ASCII85.encode($text), blob8.new('9jqo^BlbD-BleB1DJ+*+F(f,q~>'.encode), 'encode';
+is-deeply PDF::Native::Filter::ASCII85.decode("9jqo^BlbD-\nBleB1DJ+*+F(f,q~>".encode), blob8.new($text), 'decode, with whitespace';
+is-deeply PDF::Native::Filter::ASCII85.encode(blob8.new(0 xx 8)), blob8.new('zz~>'.encode), 'encode zeros';
+is-deeply PDF::Native::Filter::ASCII85.decode('z9jqo^~>'.encode), blob8.new(0, 0, 0, 0, |'Man '.encode), "decode 'z'";
+
+my $data = test-data(1001);
+my $encoded = PDF::Native::Filter::ASCII85.encode($data);
+is-deeply PDF::Native::Filter::ASCII85.decode($encoded), $data, 'round-trip';
+
+my PDF::Native::Filter::ASCII85::Stream $encoder .= new: :encode;
+is-deeply streamed($encoder, $data, 9), buf8.new($encoded), 'streamed encoding';
+
+dies-ok { PDF::Native::Filter::ASCII85.decode('uuuuu~>'.encode) }, 'overflow';
+dies-ok { PDF::Native::Filter::ASCII85.decode('9jqo^B~>'.encode) }, 'single character final group';
@@ -0,0 +1,34 @@
+use v6;
+use Test;
+
+use lib 't/lib';
+use FilterTest;
+use PDF::Native::Filter::Flate;
+use PDF::Native::Filter::Predictors;
+
+plan :skip-all("libpdf was built without zlib")
+    unless PDF::Native::Filter::Flate.available;
+
+plan 20;
+
+my $rand-data = test-data(240);
+
+for flat 1, 2, 10 .. 15 -> $Predictor {
+    for 8, 4 -> $BitsPerComponent {
+        my %opts = :$Predictor, :Columns(4), :Colors(3), :$BitsPerComponent;
+        my $encoded = PDF::Native::Filter::Flate.encode($rand-data, |%opts);
+        is-deeply PDF::Native::Filter::Flate.decode($encoded, |%opts), $rand-data, "predictor $Predictor, bpc $BitsPerComponent round-trip";
+    }
+}
+
+my $png = PDF::Native::Filter::Predictors.encode($rand-data, :Predictor(12), :Columns(6));
+my $inflated = PDF::Native::Filter::Flate.decode(PDF::Native::Filter::Flate.encode($png), :Predictor(12), :Columns(6));
+is-deeply $inflated, PDF::Native::Filter::Predictors.decode($png, :Predictor(12), :Columns(6)), 'decode matches Predictors.decode';
+
+my $encoded = PDF::Native::Filter::Flate.encode($rand-data, :level(9));
+is-deeply PDF::Native::Filter::Flate.decode($encoded), $rand-data, 'level 9 round-trip';
+
+my $partial = PDF::Native::Filter::Flate.decode($encoded.subbuf(0, $encoded.bytes - 8));
+is-deeply $partial, $rand-data.subbuf(0, $partial.bytes), 'truncated stream';
+
+dies-ok { PDF::Native::Filter::Flate.decode(blob8.new(1, 2, 3, 4)) }, 'corrupt stream';
@@ -0,0 +1,45 @@
+use v6;
+use Test;
+plan 12;
+
+use lib 't/lib';
+use FilterTest;
+use PDF::Native::Filter::LZW;
+use PDF::Native::Filter::LZW::Stream;
+use PDF::Native::Filter::Predictors;
+
+# example from the PDF specification
+my $example = '-----A---B'.encode('latin-1');
+my $example-encoded = blob8.new(0x80, 0x0B, 0x60, 0x50, 0x22, 0x0C, 0x0C, 0x85, 0x01);
+is-deeply PDF::Native::Filter::LZW.encode($example), $example-encoded, 'encode';
+is-deeply PDF::Native::Filter::LZW.decode($example-encoded), blob8.new($example), 'decode';
+
+# long enough to fill the table, and clear it
+my $data = test-data(20000);
+
+for 0, 1 -> $EarlyChange {
+    my $encoded = PDF::Native::Filter::LZW.encode($data, :$EarlyChange);
+    is-deeply PDF::Native::Filter::LZW.decode($encoded, :$EarlyChange), $data, "EarlyChange $EarlyChange round-trip";
+}
+
+for 2, 12, 15 -> $Predictor {
+    my %opts = :$Predictor, :Columns(10), :Colors(3), :BitsPerComponent(8);
+    my $encoded = PDF::Native::Filter::LZW.encode($data.subbuf(0, 19980), |%opts);
+    is-deeply PDF::Native::Filter::LZW.decode($encoded, |%opts), $data.subbuf(0, 19980), "predictor $Predictor round-trip";
+}
+
+my $png = PDF::Native::Filter::Predictors.encode($data, :Predictor(12), :Columns(8));
+is-deeply PDF::Native::Filter::LZW.decode(PDF::Native::Filter::LZW.encode($png), :Predictor(12), :Columns(8)),
+    PDF::Native::Filter::Predictors.decode($png, :Predictor(12), :Columns(8)), 'decode matches Predictors.decode';
+
+my $encoded = PDF::Native::Filter::LZW.encode($data);
+my PDF::Native::Filter::LZW::Stream $encoder .= new: :encode;
+is-deeply streamed($encoder, $data, 333), buf8.new($encoded), 'streamed encoding';
+
+my PDF::Native::Filter::LZW::Stream $decoder .= new;
+is-deeply chunked($decoder, $encoded, 7), buf8.new($data), 'streamed decoding';
+
+my $partial = PDF::Native::Filter::LZW.decode($encoded.subbuf(0, 1000));
+is-deeply $partial, $data.subbuf(0, $partial.bytes), 'truncated stream';
+
+dies-ok { PDF::Native::Filter::LZW.decode(blob8.new(0x80, 0x7F, 0xFF, 0xFF)) }, 'bad code';
@@ -0,0 +1,39 @@
+use v6;
+use Test;
+plan 11;
+
+use lib 't/lib';
+use FilterTest;
+use PDF::Native::Filter::Predictors;
+use PDF::Native::Filter::Predictors::Stream;
+
+my $data = blob8.new: (^600).map: { ($_ * 31 + $_ div 24) % 256 };
+my %opts = :Columns(8), :Colors(3);
+
+for 12, 15 -> $Predictor {
+    my $encoded = PDF::Native::Filter::Predictors.encode($data, :$Predictor, |%opts);
+
+    my PDF::Native::Filter::Predictors::Stream $encoder .= new: :$Predictor, |%opts, :encode;
+    is-deeply chunked($encoder, $data, 7), buf8.new($encoded), "PNG predictor ($Predictor) streamed encoding";
+
+    my PDF::Native::Filter::Predictors::Stream $decoder .= new: :$Predictor, |%opts;
+    is-deeply chunked($decoder, $encoded, 13), buf8.new($data), "PNG predictor ($Predictor) streamed decoding";
+}
+
+# encoded in bands of rows, at 4 bits per component
+my $image = test-data(600_000);
+for 11, 14, 15 -> $Predictor {
+    my %png = :$Predictor, :Columns(20), :Colors(3), :BitsPerComponent(4);
+    my $encoded = PDF::Native::Filter::Predictors.encode($image, |%png, :threads(4));
+    my PDF::Native::Filter::Predictors::Stream $decoder .= new: |%png;
+    is-deeply chunked($decoder, $encoded, 4096), buf8.new($image), "PNG predictor ($Predictor) bands, 4 bit";
+}
+
+my PDF::Native::Filter::Predictors::Stream $encoder .= new: :Predictor(2), :BitsPerComponent(4), |%opts, :encode;
+my PDF::Native::Filter::Predictors::Stream $decoder .= new: :Predictor(2), :BitsPerComponent(4), |%opts;
+is-deeply chunked($decoder, chunked($encoder, $data, 5), 11), buf8.new($data), 'TIFF predictor streamed round-trip';
+is $decoder.rows, 50, 'rows';
+
+$decoder .= new: :Predictor(10), :Columns(4);
+is $decoder.put(blob8.new(1, 2, 3)).bytes, 0, 'partial row';
+dies-ok { $decoder.put(blob8.new(4, 5, 9, 1, 2, 3, 4)) }, 'bad PNG tag';
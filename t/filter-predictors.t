@@ -1,6 +1,6 @@
 use v6;
 use Test;
-plan 49;
+plan 66;
 
 use PDF::Native::Filter::Predictors;
 
@@ -116,3 +116,34 @@ lives-ok {$decoded = PDF::Native::Filter::Predictors.decode($encoded, |%params)}
 
 is-deeply $decoded, $rand, "%params round-trip with prediction";
 
+
+# wider rows, with 3 and 4 byte pixels
+my $pixels = blob8.new: (^384).map: { ($_ * 53 + $_ div 7) % 256 };
+for 3, 4 -> $Colors {
+    for 10 .. 14 -> $Predictor {
+        my $encode = PDF::Native::Filter::Predictors.encode($pixels, :Columns(16), :$Colors, :$Predictor);
+        is-deeply PDF::Native::Filter::Predictors.decode($encode, :Columns(16), :$Colors, :$Predictor), $pixels, "PNG predictor ($Predictor) $Colors colors - round-trip";
+    }
+}
+
+# PNG optimum (15) chooses a tag for each row
+my $rows = blob8.new: 0, 0, 0, 0,   10, 20, 30, 40,   10, 20, 30, 40;
+my $optimum = PDF::Native::Filter::Predictors.encode($rows, :Columns(4), :Predictor(15));
+is-deeply $optimum.list.rotor(5).map(*[0]).list, (0, 1, 2), "PNG optimum predictor - per-row tags";
+is-deeply PDF::Native::Filter::Predictors.decode($optimum, :Columns(4), :Predictor(15)), $rows, "PNG optimum predictor - round-trip";
+
+# large enough to be split into bands of rows
+my $image = blob8.allocate(600 * 3 * 400, 42);
+$image.subbuf-rw(0, 2048) = blob8.new((^2048).map(* % 251));
+for 2, 15 -> $Predictor {
+    my %opts = :$Predictor, :Columns(600), :Colors(3);
+    is-deeply PDF::Native::Filter::Predictors.encode($image, |%opts, :threads(4)), PDF::Native::Filter::Predictors.encode($image, |%opts, :threads(1)), "predictor ($Predictor) threaded encoding";
+}
+my $tiff = PDF::Native::Filter::Predictors.encode($image, :Predictor(2), :Columns(600), :Colors(3), :threads(1));
+is-deeply PDF::Native::Filter::Predictors.decode($tiff, :Predictor(2), :Columns(600), :Colors(3), :threads(4)), $image, "TIFF predictor threaded decoding";
+
+# bilevel TIFF, with rows padded to a whole byte
+my $bilevel = blob8.new: 0b11110000, 0b11000000,  0b11110000, 0b11000000;
+my $bilevel-encoded = blob8.new: 0b10001000, 0b10000000,  0b10001000, 0b10000000;
+is-deeply PDF::Native::Filter::Predictors.encode($bilevel, :Predictor(2), :Columns(10), :BitsPerComponent(1)), $bilevel-encoded, "TIFF predictor 1 bpc - encoding";
+is-deeply PDF::Native::Filter::Predictors.decode($bilevel-encoded, :Predictor(2), :Columns(10), :BitsPerComponent(1)), $bilevel, "TIFF predictor 1 bpc - decoding";
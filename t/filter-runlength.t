@@ -0,0 +1,19 @@
+use v6;
+use Test;
+plan 5;
+
+use lib 't/lib';
+use FilterTest;
+use PDF::Native::Filter::RunLength;
+use PDF::Native::Filter::RunLength::Stream;
+
+is-deeply PDF::Native::Filter::RunLength.encode(blob8.new(1, 2, 3, 3, 3, 3)), blob8.new(1, 1, 2, 253, 3, 128), 'encode';
+is-deeply PDF::Native::Filter::RunLength.decode(blob8.new(2, 7, 8, 9, 254, 5, 128, 42)), blob8.new(7, 8, 9, 5, 5, 5), 'decode';
+
+my $data = blob8.new: (^2000).map: { ($_ div 150) % 3 ?? $_ % 256 !! 42 };
+my $encoded = PDF::Native::Filter::RunLength.encode($data);
+ok $encoded.bytes < $data.bytes, 'compressed';
+is-deeply PDF::Native::Filter::RunLength.decode($encoded), $data, 'round-trip';
+
+my PDF::Native::Filter::RunLength::Stream $decoder .= new;
+is-deeply streamed($decoder, $encoded, 5), buf8.new($data), 'streamed decoding';
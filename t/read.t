@@ -1,6 +1,6 @@
 use v6;
 use Test;
-plan 5;
+plan 6;
 
 use PDF::Native::Reader;
 
@@ -50,4 +50,15 @@ given PDF::Native::Reader.new {
          23, inuse, 9000000100, 2,
      );
      is-deeply .read-xref($xref), @xref, '.read-xref';
+
+     my $pdf = ('%PDF-1.4',
+                '1 0 obj << /Type /Catalog >> endobj',
+                '2 0 obj 42',
+                '1 0 obj << /Type /Catalog /V 2 >> endobj',
+                '').join(Lf).encode('latin-1');
+     @xref = (
+         1, inuse, 56, 0,
+         2, inuse, 45, 0,
+     );
+     is-deeply .repair-xref($pdf), @xref, '.repair-xref';
 }
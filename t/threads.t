@@ -34,5 +34,13 @@ subtest 'parser', {
     }
 }
 
+subtest 'shared', {
+    my COSDict:D $dict = COSNode.parse('<<' ~ (^100).map({ "/K$_ $_" }).join(' ') ~ '>>');
+    my Int:D @val[MAX_THREADS];
+    for 1..MAX_LOOP {
+        @val = blat { $dict{'K' ~ $_}.value };
+    }
+    is-deeply @val.List, (^MAX_THREADS).List, 'shared dictionary';
+}
 
 done-testing;
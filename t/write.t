@@ -1,6 +1,6 @@
 use v6;
 use Test;
-plan 34;
+plan 41;
 
 use PDF::Native::Writer;
 
@@ -19,6 +19,13 @@ given PDF::Native::Writer {
      is .write-int(42), "42";
      is .write-int(-42), "-42";
      is .write-int(-0), "0";
+     is .write-int(-2**63), "-9223372036854775808";
+     is .write-int(123456, Blob[uint8].allocate(5)), "";
+     is .write-real(0.000005e0), "0.00001";
+     is .write-real(0.000025e0), "0.00003";
+     is .write-real(-0.000001e0), "-0";
+     is .write-real(12345678.96e0), "12345679";
+     is .write-real(pi, Blob[uint8].allocate(6)), "";
      is .write-literal("Hi"), '(Hi)';
      is .write-literal("A\rB\nC\fD\bE\t"), '(A\rB\nC\fD\bE\t)';
      is .write-literal(""), '()';